@@ -43,6 +43,10 @@ public:
 
 			// vista or later, load the large icons.
 			::SHGetImageList(SHIL_JUMBO, IID_IImageList, (void **)&m_pImageList);
+
+			// persist the scaled icons, so the next launch paints from the store without decoding.
+			SIZE szThumbnail = GetThumbnailSize(m_pCollectionView);
+			m_pCollectionView->GetThumbnailStore()->Open(CPaintManagerUI::GetInstancePath() + _T("example-1.thumbnails"), szThumbnail, 4096);
 	
 			// !!!data source is ready, reload.
 			m_pCollectionView->ReloadData();
@@ -116,17 +120,78 @@ public:
 
 	// The collection view is about to display an item. Use this method to fill data into the item view.
 	void CollectionViewWillDisplayItem(UICollectionView *pCollectionView, UICollectionViewItem *pItemView, int nItemIndex) {
+		CollectionViewWillDisplayItemWithQuality(pCollectionView, pItemView, nItemIndex, UICollectionViewItemQualityFull);
+	}
+
+	// Same as `CollectionViewWillDisplayItem`, but with a quality hint decided by the scroll velocity.
+	UICollectionViewItemQuality CollectionViewWillDisplayItemWithQuality(UICollectionView *pCollectionView, UICollectionViewItem *pItemView, int nItemIndex, UICollectionViewItemQuality quality) {
 
 		CIconUI *pIconUI = dynamic_cast<CIconUI *>(pItemView->GetPreview());
-		if (pIconUI) {
-			HICON hIcon = NULL;
-			m_pImageList->GetIcon(nItemIndex, 0, &hIcon);
-			pIconUI->SetIcon(hIcon);
+		if (!pIconUI) return UICollectionViewItemQualityFull;
+
+		// items only flash by while scrolling this fast, leave them empty.
+		if (quality == UICollectionViewItemQualityPlaceholder) {
+			pIconUI->SetThumbnail(UICollectionViewThumbnailPtr());
+			return quality;
 		}
+
+		SIZE szThumbnail = GetThumbnailSize(pCollectionView);
+
+		// the system image list has no source timestamp, use the number of images to detect changes.
+		// a real application should use the last write time of the source file instead.
+		int nCount = 0;
+		m_pImageList->GetImageCount(&nCount);
+		UINT64 nTimestamp = (UINT64)nCount;
+
+		// only decode the icon if it is neither in the cache nor in the store, a larger cached
+		// thumbnail is downscaled instead of decoded again, e.g. after the item size shrinks.
+		CDuiString sIdentifier;
+		sIdentifier.Format(L"sysimagelist:%d", nItemIndex);
+		UICollectionViewThumbnailCache *pCache = pCollectionView->GetThumbnailCache();
+		UICollectionViewThumbnailStore *pStore = pCollectionView->GetThumbnailStore();
+		UICollectionViewThumbnailPtr pThumbnail = pCache->LookupNearest(sIdentifier, szThumbnail);
+		if (!pThumbnail) {
+			pThumbnail = pStore->Lookup(sIdentifier, nTimestamp);
+
+			// don't decode while scrolling fast, the item will be filled again once scrolling settles.
+			if (!pThumbnail && quality == UICollectionViewItemQualityLow) {
+				pIconUI->SetThumbnail(UICollectionViewThumbnailPtr());
+				return quality;
+			}
+
+			if (!pThumbnail) {
+				HICON hIcon = NULL;
+				m_pImageList->GetIcon(nItemIndex, 0, &hIcon);
+				pThumbnail = pCache->CreateThumbnail(szThumbnail);
+				CIconUI::RenderIcon(pThumbnail, hIcon);
+				pStore->Store(sIdentifier, nTimestamp, pThumbnail.get());
+				if (hIcon) ::DestroyIcon(hIcon);
+			}
+			pThumbnail = pCache->Insert(sIdentifier, szThumbnail, pThumbnail);
+		}
+		pIconUI->SetThumbnail(pThumbnail);
+
+		return UICollectionViewItemQualityFull;
+	}
+
+	// The collection view is about to recycle an item for reuse. Use this method to clean up resources.
+	void CollectionViewWillRecycleItem(UICollectionView *pCollectionView, UICollectionViewItem *pItemView) {
+
+		// release our reference, the thumbnail stays in the cache. the item is still at its former position, so it
+		// isn't repainted.
+		CIconUI *pIconUI = dynamic_cast<CIconUI *>(pItemView->GetPreview());
+		if (pIconUI) pIconUI->ReleaseThumbnail();
 	}
 
 protected:
 
+	// The preview fills the item except its inset.
+	SIZE GetThumbnailSize(UICollectionView *pCollectionView) {
+		SIZE szThumbnail = CollectionViewItemSize(pCollectionView);
+		szThumbnail.cx -= 10; szThumbnail.cy -= 10;
+		return szThumbnail;
+	}
+
     CPaintManagerUI m_PaintMgr;
 	UICollectionView *m_pCollectionView;
 	IImageList *m_pImageList;
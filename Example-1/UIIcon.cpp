@@ -5,37 +5,45 @@ namespace DuiLib
 {
 
 // Default Constructor
-CIconUI::CIconUI() : m_hIcon(NULL)
+CIconUI::CIconUI()
 {
 }
 
 // Default Destructor
 CIconUI::~CIconUI()
 {
-	::DestroyIcon(m_hIcon);
 }
 
-// Set the icon image to display.
-VOID CIconUI::SetIcon(HICON hIcon)
+// Set the thumbnail to display, the thumbnail is shared with the collection view's cache.
+VOID CIconUI::SetThumbnail(UICollectionViewThumbnailPtr pThumbnail)
 {
-	if (m_hIcon != hIcon) {
-		::DestroyIcon(m_hIcon);
-		m_hIcon = hIcon;
+	if (m_pThumbnail != pThumbnail) {
+		m_pThumbnail = pThumbnail;
 		Invalidate();
 	}
 }
 
+// Render an icon into a thumbnail, the thumbnail might be a slot of an atlas page.
+void CIconUI::RenderIcon(UICollectionViewThumbnailPtr pThumbnail, HICON hIcon)
+{
+	if (!pThumbnail || !hIcon) return;
+
+	// scale the icon only once, DrawIconEx produces premultiplied pixels on a transparent DIB.
+	RECT rcSource = pThumbnail->GetSourceRect();
+	HDC hMemDC = ::CreateCompatibleDC(NULL);
+	HBITMAP hOldBitmap = (HBITMAP)::SelectObject(hMemDC, pThumbnail->GetBitmap());
+	::DrawIconEx(hMemDC, rcSource.left, rcSource.top, hIcon, rcSource.right - rcSource.left, 
+		rcSource.bottom - rcSource.top, 0, NULL, DI_NORMAL);
+	::SelectObject(hMemDC, hOldBitmap);
+	::DeleteDC(hMemDC);
+}
+
 // Paint icon as background image.
 void CIconUI::PaintBkImage(HDC hDC)
 {
-	if (!m_hIcon) return;
+	if (!m_pThumbnail) return;
 
-	// It is better if we can draw the icons using CRenderEngine.
-	::DrawIconEx(
-		hDC, m_rcItem.left, m_rcItem.top, m_hIcon, m_rcItem.right - m_rcItem.left, 
-		m_rcItem.bottom - m_rcItem.top, 0, 0, DI_NORMAL
-		);
+	m_pThumbnail->Draw(hDC, m_rcItem, m_rcPaint);
 }
 
 }
-
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "UIlib.h"
+#include "UICollectionViewThumbnailCache.h"
 
 namespace DuiLib
 {
@@ -19,8 +20,14 @@ public:
 	// Set class name for this control.
 	virtual LPCTSTR GetClass() const { return L"CIconUI"; }
 
-	// Set the icon image to display.
-	virtual VOID SetIcon(HICON hIcon);
+	// Set the thumbnail to display, the thumbnail is shared with the collection view's cache.
+	virtual VOID SetThumbnail(UICollectionViewThumbnailPtr pThumbnail);
+
+	// Drop the thumbnail without repainting, e.g. when the item is recycled.
+	VOID ReleaseThumbnail() { m_pThumbnail.reset(); }
+
+	// Render an icon into a thumbnail, the thumbnail might be a slot of an atlas page.
+	static void RenderIcon(UICollectionViewThumbnailPtr pThumbnail, HICON hIcon);
 
 protected:
 
@@ -29,7 +36,7 @@ protected:
 
 private:
 
-	HICON m_hIcon;
+	UICollectionViewThumbnailPtr m_pThumbnail;
 };
 
 }
@@ -0,0 +1,156 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewBindQueue.h"
+#include <set>
+
+using namespace DuiLib;
+
+// Replays the layout passes of the content view against a simulated clock: a pass only runs when the window
+// has been repainted, and the only repaint of an idle window is the one of pending cells when the timer fires.
+class LayoutSimulation
+{
+public:
+
+	LayoutSimulation(int nFirst, int nLast, double fBindCost)
+		:m_nFirst(nFirst), m_nLast(nLast), m_fBindCost(fBindCost), m_uNow(1000), m_nPasses(0) {}
+
+	// Run a layout pass, binding visible items like `UICollectionViewContentView::SetPos()`.
+	void RunPass(UICollectionViewBindQueue &queue, bool bScrolling)
+	{
+		double fElapsed = 0;
+		queue.BeginPass(m_nFirst, m_nLast, m_uNow, bScrolling);
+		for (int i = m_nFirst; i <= m_nLast; i ++) {
+			if (m_Bound.count(i)) continue;
+			UICollectionViewBindQueue::Action action = queue.Decide(i, fElapsed);
+			if (action == UICollectionViewBindQueue::ActionDefer || action == UICollectionViewBindQueue::ActionWait) continue;
+			m_Bound.insert(i);
+			fElapsed += m_fBindCost;
+		}
+		m_nPasses ++;
+	}
+
+	// Let the window idle until the timer fires, return false if no timer is set or nothing is repainted by it.
+	bool FireTimer(UICollectionViewBindQueue &queue)
+	{
+		int nDelay = queue.GetNextDelay();
+		if (nDelay < 0) return false;
+		m_uNow += nDelay;
+		return !queue.GetPending().empty();
+	}
+
+	int GetBoundCount() const { return (int)m_Bound.size(); }
+	int GetPasses() const { return m_nPasses; }
+	bool IsBound(int nIndex) const { return m_Bound.count(nIndex) != 0; }
+
+private:
+
+	int m_nFirst; // first visible index.
+	int m_nLast; // last visible index.
+	double m_fBindCost; // milliseconds to bind an item.
+	uint32_t m_uNow; // simulated tick.
+	int m_nPasses; // layout passes run.
+	std::set<int> m_Bound; // bound indexes.
+};
+
+// A layout over the bind budget binds some items per pass, and the timer keeps repainting the rest until every
+// visible item is bound, without any input.
+static void TestBudgetBindsEveryVisibleItem()
+{
+	UICollectionViewBindQueue queue;
+	queue.SetBudget(8);
+
+	LayoutSimulation simulation(0, 59, 3.0);
+	simulation.RunPass(queue, false);
+	UICV_CHECK(simulation.GetBoundCount() == 3);
+	UICV_CHECK(queue.GetPending().size() == 57);
+	UICV_CHECK(queue.GetNextDelay() == 1);
+
+	while (simulation.GetBoundCount() < 60 && simulation.GetPasses() < 100) {
+		bool bRepainted = simulation.FireTimer(queue);
+		UICV_CHECK(bRepainted);
+		if (!bRepainted) break;
+		simulation.RunPass(queue, false);
+	}
+	UICV_CHECK(simulation.GetBoundCount() == 60);
+	UICV_CHECK(simulation.GetPasses() == 20);
+	UICV_CHECK(queue.GetPending().empty() && queue.GetNextDelay() == -1);
+}
+
+// Items appearing while scrolling wait for the dwell time, then they are bound within the budget.
+static void TestDwellTimeThenBudget()
+{
+	UICollectionViewBindQueue queue;
+	queue.SetDwellTime(120);
+	queue.SetBudget(8);
+
+	LayoutSimulation simulation(10, 29, 3.0);
+	simulation.RunPass(queue, true);
+	UICV_CHECK(simulation.GetBoundCount() == 0);
+	UICV_CHECK(queue.GetNextDelay() == 120);
+
+	// scrolling stopped, the timer repaints the skeletons until all of them are bound.
+	while (simulation.GetBoundCount() < 20 && simulation.GetPasses() < 100) {
+		if (!simulation.FireTimer(queue)) break;
+		simulation.RunPass(queue, false);
+	}
+	UICV_CHECK(simulation.GetBoundCount() == 20);
+	UICV_CHECK(queue.GetNextDelay() == -1);
+}
+
+// Pending items scrolled out, or past the end of the data, are forgotten.
+static void TestPendingItemsAreForgotten()
+{
+	UICollectionViewBindQueue queue;
+	queue.SetDwellTime(100);
+
+	queue.BeginPass(0, 9, 1000, true);
+	for (int i = 0; i <= 9; i ++) UICV_CHECK(queue.Decide(i, 0) == UICollectionViewBindQueue::ActionDefer);
+	UICV_CHECK(queue.Decide(3, 0) == UICollectionViewBindQueue::ActionWait);
+
+	queue.BeginPass(5, 14, 1050, true);
+	UICV_CHECK(!queue.IsPending(4) && queue.IsPending(5) && queue.IsPending(9));
+	UICV_CHECK(queue.GetNextDelay() == 50);
+
+	queue.RemoveFrom(8);
+	UICV_CHECK(queue.GetPending().size() == 3);
+
+	// due items are bound and have to be repainted.
+	queue.BeginPass(5, 14, 1100, false);
+	UICV_CHECK(queue.Decide(5, 0) == UICollectionViewBindQueue::ActionBindPending);
+	UICV_CHECK(queue.Decide(12, 0) == UICollectionViewBindQueue::ActionBind);
+	UICV_CHECK(!queue.IsPending(5));
+
+	queue.Clear();
+	UICV_CHECK(queue.GetNextDelay() == -1);
+}
+
+// Ticks wrapping around don't delay pending items forever.
+static void TestTickWrapAround()
+{
+	UICollectionViewBindQueue queue;
+	queue.SetDwellTime(100);
+
+	queue.BeginPass(0, 0, 0xFFFFFFC0, true);
+	UICV_CHECK(queue.Decide(0, 0) == UICollectionViewBindQueue::ActionDefer);
+	queue.BeginPass(0, 0, 0x00000010, false);
+	UICV_CHECK(queue.GetNextDelay() == 20);
+	queue.BeginPass(0, 0, 0x00000024, false);
+	UICV_CHECK(queue.Decide(0, 0) == UICollectionViewBindQueue::ActionBindPending);
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "BindQueue.BudgetBindsEveryVisibleItem", TestBudgetBindsEveryVisibleItem },
+		{ "BindQueue.DwellTimeThenBudget", TestDwellTimeThenBudget },
+		{ "BindQueue.PendingItemsAreForgotten", TestPendingItemsAreForgotten },
+		{ "BindQueue.TickWrapAround", TestTickWrapAround },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,195 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewCanvas.h"
+#include <stdlib.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace DuiLib;
+
+// Golden images are rendered once, checked by eye and committed. Run the tests with UICV_UPDATE_GOLDEN=1
+// in the environment to write them again after an intended change, a mismatching frame is saved next to
+// the test executable as `<name>.actual.bmp`.
+#ifndef UICV_GOLDEN_DIR
+#define UICV_GOLDEN_DIR "Golden"
+#endif
+
+// Background of the scenes, an opaque white.
+static const uint32_t s_uBackground = 0xFFFFFFFF;
+
+// A translucent ARGB color, the default selected item background.
+static const uint32_t s_dwTranslucent = 0x6684ACDD;
+
+// Blend a premultiplied color over a pixel, the reference formula of all blending primitives.
+static uint32_t Blend(uint32_t uDst, uint32_t uSrc)
+{
+	uint32_t uPixel = 0;
+	for (int nShift = 0; nShift < 32; nShift += 8) {
+		double c = ((uSrc >> nShift) & 0xFF) + ((uDst >> nShift) & 0xFF) * (255 - (uSrc >> 24)) / 255.0;
+		uPixel |= (uint32_t)(c > 255 ? 255 : (int)(c + 0.5)) << nShift;
+	}
+	return uPixel;
+}
+
+// Premultiply an ARGB color.
+static uint32_t Premultiply(uint32_t dwColor)
+{
+	uint32_t a = dwColor >> 24;
+	uint32_t uPixel = a << 24;
+	for (int nShift = 0; nShift < 24; nShift += 8) {
+		uPixel |= (uint32_t)((((dwColor >> nShift) & 0xFF) * a + 127) / 255) << nShift;
+	}
+	return uPixel;
+}
+
+// Load a top-down 32bpp BMP file written by `UICollectionViewCanvas::SaveBitmap` into a canvas of the same size.
+static bool LoadBitmap(const std::string &sPath, UICollectionViewCanvas &canvas)
+{
+	std::ifstream file(sPath.c_str(), std::ios::in | std::ios::binary);
+	uint8_t header[54] = { 0 };
+	if (!file.read((char *)header, sizeof(header)) || header[0] != 'B' || header[1] != 'M') return false;
+
+	auto Get = [&header](int nOffset) {
+		return (uint32_t)header[nOffset] | ((uint32_t)header[nOffset + 1] << 8) | ((uint32_t)header[nOffset + 2] << 16) | ((uint32_t)header[nOffset + 3] << 24);
+	};
+	if ((int)Get(18) != canvas.GetWidth() || (int)Get(22) != -canvas.GetHeight() || (Get(28) & 0xFFFF) != 32) return false;
+
+	for (int y = 0; y < canvas.GetHeight(); y ++) {
+		if (!file.read((char *)(canvas.GetBits() + (ptrdiff_t)y * canvas.GetStride()), (std::streamsize)canvas.GetWidth() * 4)) return false;
+	}
+	return true;
+}
+
+// Compare a frame with its golden image, or write the golden image in update mode.
+static void CheckGolden(const UICollectionViewCanvas &canvas, const char *pstrName)
+{
+	std::string sGolden = std::string(UICV_GOLDEN_DIR) + "/" + pstrName + ".bmp";
+	if (getenv("UICV_UPDATE_GOLDEN")) {
+		UICV_CHECK(canvas.SaveBitmap(sGolden.c_str()));
+		return;
+	}
+
+	UICollectionViewCanvas golden(canvas.GetWidth(), canvas.GetHeight());
+	bool bLoaded = LoadBitmap(sGolden, golden);
+	UICV_CHECK(bLoaded);
+	int nDiffer = bLoaded ? canvas.Compare(golden) : -1;
+	UICV_CHECK(nDiffer == 0);
+	if (nDiffer != 0) {
+		std::string sActual = std::string(pstrName) + ".actual.bmp";
+		canvas.SaveBitmap(sActual.c_str());
+		printf("  %d pixels differ from %s, the frame is saved as %s\n", nDiffer, sGolden.c_str(), sActual.c_str());
+	}
+}
+
+// Create a premultiplied test image: a gradient in color, alpha and checkers, so resampling shows up.
+static std::vector<uint32_t> CreateImage(int nWidth, int nHeight)
+{
+	std::vector<uint32_t> pixels((size_t)nWidth * nHeight);
+	for (int y = 0; y < nHeight; y ++) {
+		for (int x = 0; x < nWidth; x ++) {
+			uint32_t a = ((x / 4 + y / 4) % 2) ? 255 : 128;
+			uint32_t dwColor = (a << 24) | ((uint32_t)(x * 255 / nWidth) << 16) | ((uint32_t)(y * 255 / nHeight) << 8) | 0x40;
+			pixels[(size_t)y * nWidth + x] = Premultiply(dwColor);
+		}
+	}
+	return pixels;
+}
+
+// Opaque, translucent, clipped and partially offscreen fills, odd widths exercise the tails of the vector loop.
+static void TestFillRect()
+{
+	UICollectionViewCanvas canvas(64, 48);
+	canvas.Clear(s_uBackground);
+
+	UICollectionViewCanvas::Rect rcOpaque = { 2, 2, 21, 19 };
+	UICollectionViewCanvas::Rect rcTranslucent = { 11, 9, 40, 30 };
+	UICollectionViewCanvas::Rect rcOffscreen = { 50, 36, 80, 60 };
+	UICollectionViewCanvas::Rect rcClipped = { 30, 20, 62, 46 };
+	UICollectionViewCanvas::Rect rcClip = { 36, 24, 47, 41 };
+	canvas.FillRect(rcOpaque, 0xFF336699);
+	canvas.FillRect(rcTranslucent, s_dwTranslucent);
+	canvas.FillRect(rcOffscreen, 0x80FF0000);
+	canvas.SetClip(rcClip);
+	canvas.FillRect(rcClipped, 0xC000A000);
+	canvas.ResetClip();
+
+	// the golden image is checked against the reference formula too.
+	UICV_CHECK(canvas.GetPixel(2, 2) == 0xFF336699);
+	UICV_CHECK(canvas.GetPixel(25, 25) == Blend(s_uBackground, Premultiply(s_dwTranslucent)));
+	UICV_CHECK(canvas.GetPixel(15, 15) == Blend(0xFF336699, Premultiply(s_dwTranslucent)));
+	UICV_CHECK(canvas.GetPixel(63, 47) == Blend(s_uBackground, Premultiply(0x80FF0000)));
+	UICV_CHECK(canvas.GetPixel(35, 29) == Blend(s_uBackground, Premultiply(s_dwTranslucent)));
+	UICV_CHECK(canvas.GetPixel(36, 35) == Blend(s_uBackground, Premultiply(0xC000A000)));
+	UICV_CHECK(canvas.GetPixel(47, 35) == s_uBackground);
+	CheckGolden(canvas, "FillRect");
+}
+
+// Borders of several widths, translucent so corners blended twice would show up.
+static void TestDrawBorder()
+{
+	UICollectionViewCanvas canvas(64, 48);
+	canvas.Clear(s_uBackground);
+
+	UICollectionViewCanvas::Rect rcThin = { 2, 2, 30, 22 };
+	UICollectionViewCanvas::Rect rcThick = { 34, 2, 62, 22 };
+	UICollectionViewCanvas::Rect rcNarrow = { 2, 26, 7, 46 };
+	UICollectionViewCanvas::Rect rcClipped = { 12, 26, 70, 60 };
+	canvas.DrawBorder(rcThin, 1, 0xFF84ACDD);
+	canvas.DrawBorder(rcThick, 3, s_dwTranslucent);
+	canvas.DrawBorder(rcNarrow, 4, s_dwTranslucent); // edges overlap.
+	canvas.DrawBorder(rcClipped, 2, 0x80000000);
+
+	uint32_t uBorder = Blend(s_uBackground, Premultiply(s_dwTranslucent));
+	UICV_CHECK(canvas.GetPixel(2, 2) == 0xFF84ACDD && canvas.GetPixel(29, 21) == 0xFF84ACDD);
+	UICV_CHECK(canvas.GetPixel(3, 3) == s_uBackground);
+	UICV_CHECK(canvas.GetPixel(34, 2) == uBorder && canvas.GetPixel(61, 21) == uBorder && canvas.GetPixel(36, 12) == uBorder);
+	UICV_CHECK(canvas.GetPixel(37, 12) == s_uBackground);
+	UICV_CHECK(canvas.GetPixel(4, 36) == uBorder && canvas.GetPixel(6, 45) == uBorder);
+	CheckGolden(canvas, "DrawBorder");
+}
+
+// Images drawn 1:1, upscaled, downscaled and clipped.
+static void TestDrawImage()
+{
+	UICollectionViewCanvas canvas(64, 48);
+	canvas.Clear(s_uBackground);
+
+	std::vector<uint32_t> image = CreateImage(16, 16);
+	UICollectionViewCanvas::Rect rcOriginal = { 2, 2, 18, 18 };
+	UICollectionViewCanvas::Rect rcUpscaled = { 22, 2, 62, 42 };
+	UICollectionViewCanvas::Rect rcDownscaled = { 2, 22, 9, 29 };
+	UICollectionViewCanvas::Rect rcLanczos = { 2, 32, 13, 43 };
+	UICollectionViewCanvas::Rect rcClipped = { 12, 22, 28, 38 };
+	UICollectionViewCanvas::Rect rcClip = { 14, 24, 20, 47 };
+	UICV_CHECK(canvas.DrawImage(rcOriginal, &image[0], 16, 16, 16));
+	UICV_CHECK(canvas.DrawImage(rcUpscaled, &image[0], 16, 16, 16, UICollectionViewImageScaler::FilterBilinear));
+	UICV_CHECK(canvas.DrawImage(rcDownscaled, &image[0], 16, 16, 16, UICollectionViewImageScaler::FilterBox));
+	UICV_CHECK(canvas.DrawImage(rcLanczos, &image[0], 16, 16, 16, UICollectionViewImageScaler::FilterLanczos));
+	canvas.SetClip(rcClip);
+	UICV_CHECK(canvas.DrawImage(rcClipped, &image[0], 16, 16, 16));
+	canvas.ResetClip();
+	UICV_CHECK(!canvas.DrawImage(rcOriginal, nullptr, 16, 16, 16));
+
+	UICV_CHECK(canvas.GetPixel(2, 2) == Blend(s_uBackground, image[0]));
+	UICV_CHECK(canvas.GetPixel(17, 17) == Blend(s_uBackground, image[15 * 16 + 15]));
+	UICV_CHECK(canvas.GetPixel(14, 24) == Blend(s_uBackground, image[2 * 16 + 2]));
+	UICV_CHECK(canvas.GetPixel(13, 24) == s_uBackground);
+	CheckGolden(canvas, "DrawImage");
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "Canvas.FillRect", TestFillRect },
+		{ "Canvas.DrawBorder", TestDrawBorder },
+		{ "Canvas.DrawImage", TestDrawImage },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,98 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewTest.h"
+#include "UICollectionViewIdleScheduler.h"
+#include <vector>
+
+using namespace DuiLib;
+
+// Return the performance counter in milliseconds.
+static double GetMilliseconds()
+{
+	LARGE_INTEGER liNow, liFrequency;
+	::QueryPerformanceCounter(&liNow);
+	::QueryPerformanceFrequency(&liFrequency);
+	return liNow.QuadPart * 1000.0 / liFrequency.QuadPart;
+}
+
+// A job working until it is asked to yield is stopped at the end of the slice and resumed by the next run.
+static void TestDeadlineSlicing()
+{
+	UICollectionViewIdleScheduler scheduler(2);
+	int nSlices = 0;
+	scheduler.Post([&nSlices](UICollectionViewIdleScheduler *pScheduler) {
+		while (!pScheduler->ShouldYield()) ::Sleep(0);
+		return ++ nSlices < 3;
+	});
+
+	double fStart = GetMilliseconds();
+	UICV_CHECK(scheduler.Run());
+	double fElapsed = GetMilliseconds() - fStart;
+	UICV_CHECK(nSlices == 1);
+	UICV_CHECK(fElapsed >= 1.5 && fElapsed < 50);
+
+	// a longer slice runs longer, the job completes on its third slice.
+	scheduler.SetSliceTime(10);
+	fStart = GetMilliseconds();
+	UICV_CHECK(scheduler.Run());
+	fElapsed = GetMilliseconds() - fStart;
+	UICV_CHECK(nSlices == 2);
+	UICV_CHECK(fElapsed >= 9);
+	UICV_CHECK(!scheduler.Run());
+	UICV_CHECK(nSlices == 3 && scheduler.IsEmpty());
+}
+
+// Short jobs complete within one slice, in the order they were posted, and are removed once done.
+static void TestJobCompletion()
+{
+	UICollectionViewIdleScheduler scheduler(50);
+	std::vector<int> order;
+	for (int i = 0; i < 3; i ++)
+		scheduler.Post([&order, i](UICollectionViewIdleScheduler *) { order.push_back(i); return false; });
+	scheduler.Post(UICollectionViewIdleScheduler::Job());
+
+	UICV_CHECK(!scheduler.Run());
+	UICV_CHECK(scheduler.IsEmpty());
+	UICV_CHECK(order.size() == 3 && order[0] == 0 && order[1] == 1 && order[2] == 2);
+	UICV_CHECK(!scheduler.Run());
+	UICV_CHECK(order.size() == 3);
+}
+
+// Jobs with work left run round robin, a job may post another one while running.
+static void TestRoundRobin()
+{
+	UICollectionViewIdleScheduler scheduler(50);
+	std::vector<int> order;
+	int nSteps = 0;
+	scheduler.Post([&order, &nSteps](UICollectionViewIdleScheduler *) { order.push_back(0); return ++ nSteps < 2; });
+	scheduler.Post([&order](UICollectionViewIdleScheduler *pScheduler) {
+		order.push_back(1);
+		pScheduler->Post([&order](UICollectionViewIdleScheduler *) { order.push_back(2); return false; });
+		return false;
+	});
+
+	UICV_CHECK(!scheduler.Run());
+	UICV_CHECK(order.size() == 4 && order[0] == 0 && order[1] == 1 && order[2] == 0 && order[3] == 2);
+
+	// removed jobs don't run.
+	scheduler.Post([&order](UICollectionViewIdleScheduler *) { order.push_back(3); return false; });
+	scheduler.RemoveAll();
+	UICV_CHECK(!scheduler.Run());
+	UICV_CHECK(order.size() == 4);
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "IdleScheduler.DeadlineSlicing", TestDeadlineSlicing },
+		{ "IdleScheduler.JobCompletion", TestJobCompletion },
+		{ "IdleScheduler.RoundRobin", TestRoundRobin },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
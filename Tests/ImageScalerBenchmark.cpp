@@ -0,0 +1,39 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewImageScaler.h"
+#include <vector>
+
+using namespace DuiLib;
+
+// Scale a full size photo to a thumbnail with every filter on every implementation the CPU supports.
+int main()
+{
+	const char *pstrFilters[] = { "box", "bilinear", "lanczos" };
+	const char *pstrPaths[] = { "scalar", "sse2", "avx2" };
+	const int nSrcWidth = 1920, nSrcHeight = 1080, nDstWidth = 256, nDstHeight = 144;
+
+	std::vector<uint32_t> src((size_t)nSrcWidth * nSrcHeight);
+	for (size_t i = 0; i < src.size(); i ++) src[i] = 0xFF000000 | (uint32_t)(i * 2654435761u >> 8);
+	std::vector<uint32_t> dst((size_t)nDstWidth * nDstHeight);
+
+	printf("%dx%d -> %dx%d\n", nSrcWidth, nSrcHeight, nDstWidth, nDstHeight);
+	for (int f = UICollectionViewImageScaler::FilterBox; f <= UICollectionViewImageScaler::FilterLanczos; f ++) {
+		double fScalar = 0;
+		for (int p = UICollectionViewImageScaler::PathScalar; p <= UICollectionViewImageScaler::GetSupportedPath(); p ++) {
+			UICollectionViewImageScaler::SetPath((UICollectionViewImageScaler::Path)p);
+			double fMicroseconds = UICollectionViewMeasure([&]() {
+				UICollectionViewImageScaler::Scale(&src[0], nSrcWidth, nSrcHeight, nSrcWidth, &dst[0], nDstWidth, nDstHeight, nDstWidth,
+					(UICollectionViewImageScaler::Filter)f);
+			});
+			if (p == UICollectionViewImageScaler::PathScalar) fScalar = fMicroseconds;
+			printf("%-8s %-6s %10.1f us %6.2fx\n", pstrFilters[f], pstrPaths[p], fMicroseconds, fScalar / fMicroseconds);
+		}
+	}
+	return 0;
+}
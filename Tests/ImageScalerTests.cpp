@@ -0,0 +1,151 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewImageScaler.h"
+#include <stdlib.h>
+#include <vector>
+
+using namespace DuiLib;
+
+static const UICollectionViewImageScaler::Filter s_Filters[] = {
+	UICollectionViewImageScaler::FilterBox,
+	UICollectionViewImageScaler::FilterBilinear,
+	UICollectionViewImageScaler::FilterLanczos,
+};
+
+static const UICollectionViewImageScaler::Path s_Paths[] = {
+	UICollectionViewImageScaler::PathScalar,
+	UICollectionViewImageScaler::PathSSE2,
+	UICollectionViewImageScaler::PathAVX2,
+};
+
+// Source and destination sizes, odd widths exercise the tails of the vector loops.
+static const int s_Sizes[][4] = {
+	{ 257, 193, 64, 48 },		// downscale.
+	{ 640, 480, 37, 29 },		// strong downscale.
+	{ 37, 29, 101, 83 },		// upscale.
+	{ 100, 10, 33, 40 },		// mixed.
+	{ 1, 1, 7, 5 },				// single pixel.
+};
+
+// Create a premultiplied image of random pixels, rows are `nStride` pixels apart.
+static std::vector<uint32_t> CreateNoise(int nWidth, int nHeight, int nStride, unsigned int nSeed)
+{
+	srand(nSeed);
+	std::vector<uint32_t> pixels((size_t)nStride * nHeight, 0xDEADBEEF);
+	for (int y = 0; y < nHeight; y ++) {
+		for (int x = 0; x < nWidth; x ++) {
+			uint32_t nA = rand() % 256;
+			uint32_t nB = rand() % (nA + 1), nG = rand() % (nA + 1), nR = rand() % (nA + 1);
+			pixels[(size_t)y * nStride + x] = nB | (nG << 8) | (nR << 16) | (nA << 24);
+		}
+	}
+	return pixels;
+}
+
+// Scale with the given implementation, return false if the CPU doesn't support it.
+static bool ScaleWithPath(UICollectionViewImageScaler::Path path, const std::vector<uint32_t> &src, int nSrcWidth, int nSrcHeight,
+	int nSrcStride, std::vector<uint32_t> &dst, int nDstWidth, int nDstHeight, UICollectionViewImageScaler::Filter filter)
+{
+	if (path > UICollectionViewImageScaler::GetSupportedPath()) return false;
+
+	UICollectionViewImageScaler::SetPath(path);
+	dst.assign((size_t)nDstWidth * nDstHeight, 0);
+	bool bScaled = UICollectionViewImageScaler::Scale(&src[0], nSrcWidth, nSrcHeight, nSrcStride, &dst[0], nDstWidth, nDstHeight, nDstWidth, filter);
+	UICollectionViewImageScaler::SetPath(UICollectionViewImageScaler::GetSupportedPath());
+	return bScaled;
+}
+
+// All implementations produce the same pixels for every filter.
+static void TestPathsAreIdentical()
+{
+	for (size_t s = 0; s < sizeof(s_Sizes) / sizeof(s_Sizes[0]); s ++) {
+		const int *pSize = s_Sizes[s];
+		int nSrcStride = pSize[0] + 3;
+		std::vector<uint32_t> src = CreateNoise(pSize[0], pSize[1], nSrcStride, (unsigned int)s + 1);
+
+		for (size_t f = 0; f < sizeof(s_Filters) / sizeof(s_Filters[0]); f ++) {
+			std::vector<uint32_t> expected;
+			UICV_CHECK(ScaleWithPath(UICollectionViewImageScaler::PathScalar, src, pSize[0], pSize[1], nSrcStride, expected, pSize[2], pSize[3], s_Filters[f]));
+
+			for (size_t p = 1; p < sizeof(s_Paths) / sizeof(s_Paths[0]); p ++) {
+				std::vector<uint32_t> actual;
+				if (!ScaleWithPath(s_Paths[p], src, pSize[0], pSize[1], nSrcStride, actual, pSize[2], pSize[3], s_Filters[f])) {
+					printf("  path %d is not supported by the CPU, skipped\n", (int)s_Paths[p]);
+					continue;
+				}
+				UICV_CHECK(actual == expected);
+			}
+		}
+	}
+}
+
+// No channel exceeds alpha in the output of any implementation and filter.
+static void TestPremultipliedAlphaStaysValid()
+{
+	for (size_t s = 0; s < sizeof(s_Sizes) / sizeof(s_Sizes[0]); s ++) {
+		const int *pSize = s_Sizes[s];
+		std::vector<uint32_t> src = CreateNoise(pSize[0], pSize[1], pSize[0], (unsigned int)s + 100);
+
+		for (size_t f = 0; f < sizeof(s_Filters) / sizeof(s_Filters[0]); f ++) {
+			for (size_t p = 0; p < sizeof(s_Paths) / sizeof(s_Paths[0]); p ++) {
+				std::vector<uint32_t> dst;
+				if (!ScaleWithPath(s_Paths[p], src, pSize[0], pSize[1], pSize[0], dst, pSize[2], pSize[3], s_Filters[f])) continue;
+
+				int nInvalid = 0;
+				for (size_t i = 0; i < dst.size(); i ++) {
+					uint32_t nA = dst[i] >> 24;
+					if ((dst[i] & 0xFF) > nA || ((dst[i] >> 8) & 0xFF) > nA || ((dst[i] >> 16) & 0xFF) > nA) nInvalid ++;
+				}
+				UICV_CHECK(nInvalid == 0);
+			}
+		}
+	}
+}
+
+// A constant image stays constant, i.e. weights sum up to one and the edges are clamped.
+static void TestConstantImageStaysConstant()
+{
+	const uint32_t nColors[] = { 0x00000000, 0xFFFFFFFF, 0x80402010, 0xFF0080FF };
+	for (size_t c = 0; c < sizeof(nColors) / sizeof(nColors[0]); c ++) {
+		for (size_t s = 0; s < sizeof(s_Sizes) / sizeof(s_Sizes[0]); s ++) {
+			const int *pSize = s_Sizes[s];
+			std::vector<uint32_t> src((size_t)pSize[0] * pSize[1], nColors[c]);
+
+			for (size_t f = 0; f < sizeof(s_Filters) / sizeof(s_Filters[0]); f ++) {
+				for (size_t p = 0; p < sizeof(s_Paths) / sizeof(s_Paths[0]); p ++) {
+					std::vector<uint32_t> dst;
+					if (!ScaleWithPath(s_Paths[p], src, pSize[0], pSize[1], pSize[0], dst, pSize[2], pSize[3], s_Filters[f])) continue;
+					UICV_CHECK(dst == std::vector<uint32_t>(dst.size(), nColors[c]));
+				}
+			}
+		}
+	}
+}
+
+// Invalid sizes and strides are rejected without touching the destination.
+static void TestInvalidArguments()
+{
+	uint32_t src[4] = { 0 }, dst[4] = { 1, 1, 1, 1 };
+	UICV_CHECK(!UICollectionViewImageScaler::Scale(nullptr, 2, 2, 2, dst, 2, 2, 2));
+	UICV_CHECK(!UICollectionViewImageScaler::Scale(src, 0, 2, 2, dst, 2, 2, 2));
+	UICV_CHECK(!UICollectionViewImageScaler::Scale(src, 2, 2, 1, dst, 2, 2, 2));
+	UICV_CHECK(!UICollectionViewImageScaler::Scale(src, 2, 2, 2, dst, 2, 2, 1));
+	UICV_CHECK(dst[0] == 1 && dst[3] == 1);
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "ImageScaler.PathsAreIdentical", TestPathsAreIdentical },
+		{ "ImageScaler.PremultipliedAlphaStaysValid", TestPremultipliedAlphaStaysValid },
+		{ "ImageScaler.ConstantImageStaysConstant", TestConstantImageStaysConstant },
+		{ "ImageScaler.InvalidArguments", TestInvalidArguments },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,218 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewLayout.h"
+#include "UICollectionViewSelection.h"
+
+using namespace DuiLib;
+
+// Compare two rects member by member.
+static bool IsEqualRect(const UICollectionViewRect &rc, int nLeft, int nTop, int nRight, int nBottom)
+{
+	return rc.left == nLeft && rc.top == nTop && rc.right == nRight && rc.bottom == nBottom;
+}
+
+// Create a layout of 100x80 items with a padding of 10, in a 600x300 view with a 17px scroll bar.
+static UICollectionViewLayout CreateLayout(int nCount, int nViewWidth = 600)
+{
+	UICollectionViewLayout layout;
+	UICollectionViewSize szItem = { 100, 80 };
+	UICollectionViewSize szPadding = { 10, 10 };
+	layout.SetItemSize(szItem);
+	layout.SetItemPadding(szPadding);
+	layout.SetCount(nCount);
+	layout.Update(nViewWidth, 300, 17);
+	return layout;
+}
+
+// Rows and columns fit the view, the scroll bar width is reserved once the content is taller than the view.
+static void TestUpdate()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	UICV_CHECK(layout.Update(600, 300, 17));
+	UICV_CHECK(layout.GetColumns() == 5 && layout.GetRows() == 5);
+	UICV_CHECK(layout.GetContentSize().cx == 583 && layout.GetContentSize().cy == 440);
+	UICV_CHECK(layout.GetPaddingFix() == 10);
+	UICV_CHECK(layout.GetRowHeight() == 90);
+
+	// a single row fits, no scroll bar.
+	layout.SetCount(5);
+	UICV_CHECK(!layout.Update(600, 300, 17));
+	UICV_CHECK(layout.GetRows() == 1 && layout.GetContentSize().cx == 600 && layout.GetContentSize().cy == 80);
+
+	// a partial last row counts as a row.
+	layout.SetCount(6);
+	layout.Update(600, 300, 17);
+	UICV_CHECK(layout.GetRows() == 2);
+
+	// negative counts are clamped.
+	layout.SetCount(-3);
+	UICV_CHECK(layout.GetCount() == 0);
+	layout.Update(600, 300, 17);
+	UICV_CHECK(layout.GetRows() == 0);
+}
+
+// Item rects are spread averagely on the X axis, a single column is centered by the padding fix.
+static void TestItemRect()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	UICV_CHECK(IsEqualRect(layout.GetItemRect(0), 0, 0, 100, 80));
+	UICV_CHECK(IsEqualRect(layout.GetItemRect(2, 1), 120, 180, 220, 260));
+	UICV_CHECK(IsEqualRect(layout.GetItemRect(13), 360, 180, 460, 260));
+
+	UICollectionViewLayout narrow = CreateLayout(25, 150);
+	UICV_CHECK(narrow.GetColumns() == 1 && narrow.GetRows() == 25);
+	UICV_CHECK(narrow.GetPaddingFix() == 16);
+	UICV_CHECK(IsEqualRect(narrow.GetItemRect(3), 16, 270, 116, 350));
+
+	UICollectionViewLayout empty;
+	UICV_CHECK(IsEqualRect(empty.GetItemRect(3), 0, 0, 0, 0));
+}
+
+// Cells intersecting a rect, a cell spans its item and the padding after it.
+static void TestItemRange()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	UICollectionViewRect rcRange = {};
+
+	UICollectionViewRect rc = { 230, 85, 350, 175 };
+	UICV_CHECK(layout.GetItemRange(rc, rcRange));
+	UICV_CHECK(IsEqualRect(rcRange, 1, 0, 2, 1));
+
+	// clamped to the last row and column.
+	UICollectionViewRect rcLarge = { -50, -50, 5000, 5000 };
+	UICV_CHECK(layout.GetItemRange(rcLarge, rcRange));
+	UICV_CHECK(IsEqualRect(rcRange, 0, 0, 4, 4));
+
+	// empty rects and layouts intersect nothing.
+	UICollectionViewRect rcEmpty = { 10, 10, 10, 50 };
+	UICV_CHECK(!layout.GetItemRange(rcEmpty, rcRange));
+	UICV_CHECK(!CreateLayout(0).GetItemRange(rc, rcRange));
+}
+
+// Visible index ranges cover whole rows around the viewport.
+static void TestVisibleRange()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	int nFirst = -1, nLast = -1;
+
+	UICV_CHECK(layout.GetVisibleRange(0, 300, nFirst, nLast));
+	UICV_CHECK(nFirst == 0 && nLast == 19);
+
+	UICV_CHECK(layout.GetVisibleRange(100, 300, nFirst, nLast));
+	UICV_CHECK(nFirst == 5 && nLast == 24);
+
+	UICV_CHECK(layout.GetVisibleRange(-40, 100, nFirst, nLast));
+	UICV_CHECK(nFirst == 0 && nLast == 4);
+
+	UICV_CHECK(!CreateLayout(0).GetVisibleRange(0, 300, nFirst, nLast));
+}
+
+// A lasso selects a column once it touches it, and a row once it passes the top of its item.
+static void TestLassoRange()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+
+	UICollectionViewRect rcLasso = { 230, 85, 350, 175 };
+	UICV_CHECK(IsEqualRect(layout.GetLassoRange(rcLasso), 2, 1, 2, 1));
+
+	// starting within an item selects its row.
+	UICollectionViewRect rcWithin = { 10, 50, 130, 100 };
+	UICV_CHECK(IsEqualRect(layout.GetLassoRange(rcWithin), 0, 0, 1, 1));
+
+	// a lasso above the content starts at the first row.
+	UICollectionViewRect rcAbove = { 0, -20, 50, 10 };
+	UICV_CHECK(IsEqualRect(layout.GetLassoRange(rcAbove), 0, 0, 0, 0));
+
+	// a lasso within the padding between columns selects no column.
+	UICollectionViewRect rcPadding = { 102, 0, 118, 50 };
+	UICollectionViewRect rcRange = layout.GetLassoRange(rcPadding);
+	UICV_CHECK(rcRange.left > rcRange.right);
+}
+
+// Keyboard moves stay in their column and stop at the first and last item, a page is the rows fitting into the view.
+static void TestMovedIndex()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	UICV_CHECK(layout.GetMovedIndex(-1, UICollectionViewMoveDown, 300) == 0);
+	UICV_CHECK(layout.GetMovedIndex(0, UICollectionViewMoveLeft, 300) == 0);
+	UICV_CHECK(layout.GetMovedIndex(4, UICollectionViewMoveRight, 300) == 5);
+	UICV_CHECK(layout.GetMovedIndex(24, UICollectionViewMoveRight, 300) == 24);
+	UICV_CHECK(layout.GetMovedIndex(2, UICollectionViewMoveUp, 300) == 2);
+	UICV_CHECK(layout.GetMovedIndex(7, UICollectionViewMoveUp, 300) == 2);
+	UICV_CHECK(layout.GetMovedIndex(7, UICollectionViewMoveDown, 300) == 12);
+	UICV_CHECK(layout.GetMovedIndex(22, UICollectionViewMoveDown, 300) == 22);
+	UICV_CHECK(layout.GetMovedIndex(2, UICollectionViewMovePageDown, 300) == 17);
+	UICV_CHECK(layout.GetMovedIndex(17, UICollectionViewMovePageDown, 300) == 24);
+	UICV_CHECK(layout.GetMovedIndex(17, UICollectionViewMovePageUp, 300) == 2);
+	UICV_CHECK(layout.GetMovedIndex(7, UICollectionViewMovePageUp, 300) == 2);
+	UICV_CHECK(layout.GetMovedIndex(12, UICollectionViewMoveHome, 300) == 0);
+	UICV_CHECK(layout.GetMovedIndex(12, UICollectionViewMoveEnd, 300) == 24);
+
+	// moving down into a partial last row stops at the last item.
+	UICV_CHECK(CreateLayout(23).GetMovedIndex(18, UICollectionViewMoveDown, 300) == 22);
+	UICV_CHECK(CreateLayout(0).GetMovedIndex(-1, UICollectionViewMoveDown, 300) == -1);
+}
+
+// Scrolling to show an item scrolls as little as possible.
+static void TestScrollPosToShow()
+{
+	UICollectionViewLayout layout = CreateLayout(25);
+	UICV_CHECK(layout.GetScrollPosToShow(12, 0, 300) == 0);
+	UICV_CHECK(layout.GetScrollPosToShow(17, 0, 300) == 50);
+	UICV_CHECK(layout.GetScrollPosToShow(2, 200, 300) == 0);
+}
+
+// Items inserted above the viewport push the anchor item down, the scroll position follows so it stays in place.
+static void TestAnchorAfterInsertion()
+{
+	UICollectionViewLayout layout = CreateLayout(100);
+	UICollectionViewAnchor anchor = layout.GetAnchor(455, 300);
+	UICV_CHECK(anchor.nIndex == 25 && anchor.nOffset == -5);
+
+	// a partial row inserted above keeps the anchor in its row.
+	std::set<int> sInserted;
+	for (int i = 0; i < 3; i ++) sInserted.insert(i);
+	UICollectionViewAnchor inserted = { UICollectionViewSelection::GetIndexAfterInsertion(anchor.nIndex, sInserted), anchor.nOffset };
+	UICV_CHECK(inserted.nIndex == 28);
+	layout.SetCount(103);
+	layout.Update(600, 300, 17);
+	UICV_CHECK(layout.GetAnchoredScrollPos(inserted) == 455);
+	UICV_CHECK(layout.GetItemRect(inserted.nIndex).top - layout.GetAnchoredScrollPos(inserted) == -5);
+
+	// a full row inserted above scrolls down by a row.
+	for (int i = 3; i < 5; i ++) sInserted.insert(i);
+	inserted.nIndex = UICollectionViewSelection::GetIndexAfterInsertion(anchor.nIndex, sInserted);
+	UICV_CHECK(inserted.nIndex == 30);
+	layout.SetCount(105);
+	layout.Update(600, 300, 17);
+	UICV_CHECK(layout.GetAnchoredScrollPos(inserted) == 545);
+
+	// items inserted below don't move it, an anchor beyond the last item anchors the last one.
+	std::set<int> sBelow;
+	sBelow.insert(60);
+	UICV_CHECK(UICollectionViewSelection::GetIndexAfterInsertion(anchor.nIndex, sBelow) == 25);
+	UICollectionViewAnchor beyond = { 200, -5 };
+	UICV_CHECK(layout.GetAnchoredScrollPos(beyond) == layout.GetItemRect(104).top + 5);
+	UICV_CHECK(CreateLayout(0).GetAnchor(0, 300).nIndex == -1);
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "Layout.Update", TestUpdate },
+		{ "Layout.ItemRect", TestItemRect },
+		{ "Layout.ItemRange", TestItemRange },
+		{ "Layout.VisibleRange", TestVisibleRange },
+		{ "Layout.LassoRange", TestLassoRange },
+		{ "Layout.MovedIndex", TestMovedIndex },
+		{ "Layout.ScrollPosToShow", TestScrollPosToShow },
+		{ "Layout.AnchorAfterInsertion", TestAnchorAfterInsertion },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,60 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewParallelRenderer.h"
+#include <vector>
+
+using namespace DuiLib;
+
+// Render a full HD viewport of items with translucent backgrounds, borders and downscaled previews
+// on 1, 2, 4 and 8 threads, the speedup is relative to the single threaded frame.
+int main()
+{
+	const int nViewWidth = 1920, nViewHeight = 1080;
+
+	UICollectionViewLayout layout;
+	UICollectionViewSize szItem = { 180, 180 };
+	UICollectionViewSize szPadding = { 13, 13 };
+	layout.SetItemSize(szItem);
+	layout.SetItemPadding(szPadding);
+	layout.SetCount(10000);
+	layout.Update(nViewWidth, nViewHeight, 17);
+
+	// previews are downscaled from a larger image on every frame, the expensive part of an item.
+	std::vector<uint32_t> preview(256 * 256);
+	for (size_t i = 0; i < preview.size(); i ++) preview[i] = 0xFF000000 | (uint32_t)(i * 2654435761u >> 8);
+	auto describe = [&preview](int nIndex, UICollectionViewRenderItem &item) {
+		item.dwBkColor = (nIndex % 7) ? 0xFFFFFFFF : 0x6684ACDD;
+		item.dwBdColor = 0xFF84ACDD;
+		item.nBorderWidth = 1;
+		item.pPreview = &preview[0];
+		item.nPreviewWidth = 256;
+		item.nPreviewHeight = 256;
+		item.nPreviewStride = 256;
+		UICollectionViewRect rcPreview = { 5, 5, 175, 175 };
+		item.rcPreview = rcPreview;
+	};
+
+	UICollectionViewCanvas canvas(layout.GetContentSize().cx, nViewHeight);
+	printf("%dx%d viewport of %dpx items\n", canvas.GetWidth(), canvas.GetHeight(), szItem.cx);
+
+	double fSingle = 0;
+	const int nThreads[] = { 1, 2, 4, 8 };
+	for (size_t t = 0; t < sizeof(nThreads) / sizeof(nThreads[0]); t ++) {
+		UICollectionViewParallelRenderer renderer(nThreads[t]);
+		int nScrollPos = 0;
+		double fMicroseconds = UICollectionViewMeasure([&]() {
+			renderer.Render(canvas, layout, nScrollPos, describe, 0xFFFFFFFF);
+			nScrollPos = (nScrollPos + 37) % 2000;
+		}, 500);
+		if (t == 0) fSingle = fMicroseconds;
+		UICollectionViewRenderStats stats = renderer.GetStats();
+		printf("%d threads %10.1f us %6.2fx  (%d items, %d tiles)\n", stats.nThreads, fMicroseconds, fSingle / fMicroseconds, stats.nItems, stats.nTiles);
+	}
+	return 0;
+}
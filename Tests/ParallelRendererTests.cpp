@@ -0,0 +1,68 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewParallelRenderer.h"
+#include <vector>
+
+using namespace DuiLib;
+
+// Create a layout of 100x80 items with a padding of 10 in a 600x400 viewport.
+static UICollectionViewLayout CreateLayout()
+{
+	UICollectionViewLayout layout;
+	UICollectionViewSize szItem = { 100, 80 };
+	UICollectionViewSize szPadding = { 10, 10 };
+	layout.SetItemSize(szItem);
+	layout.SetItemPadding(szPadding);
+	layout.SetCount(500);
+	layout.Update(600, 400, 17);
+	return layout;
+}
+
+// Frames rendered by any number of threads and tile sizes are identical to a single threaded one.
+static void TestThreadCountsAreIdentical()
+{
+	UICollectionViewLayout layout = CreateLayout();
+	std::vector<uint32_t> preview(64 * 48, 0xC0604020);
+	auto describe = [&preview](int nIndex, UICollectionViewRenderItem &item) {
+		item.dwBkColor = (nIndex % 3) ? 0x6684ACDD : 0xFFFFFFFF;
+		item.dwBdColor = 0xFF84ACDD;
+		item.nBorderWidth = 1 + nIndex % 2;
+		item.pPreview = &preview[0];
+		item.nPreviewWidth = 64;
+		item.nPreviewHeight = 48;
+		item.nPreviewStride = 64;
+		UICollectionViewRect rcPreview = { 5, 5, 95, 75 };
+		item.rcPreview = rcPreview;
+	};
+
+	UICollectionViewCanvas expected(583, 400);
+	UICollectionViewParallelRenderer single(1);
+	single.Render(expected, layout, 135, describe, 0xFFF0F0F0);
+	UICV_CHECK(single.GetStats().nThreads == 1 && single.GetStats().nItems > 0);
+
+	const int nThreads[] = { 2, 4, 8 };
+	const int nTileSizes[] = { 128, 37 };
+	for (size_t t = 0; t < sizeof(nThreads) / sizeof(nThreads[0]); t ++) {
+		for (size_t s = 0; s < sizeof(nTileSizes) / sizeof(nTileSizes[0]); s ++) {
+			UICollectionViewCanvas canvas(583, 400);
+			UICollectionViewParallelRenderer renderer(nThreads[t], nTileSizes[s]);
+			renderer.Render(canvas, layout, 135, describe, 0xFFF0F0F0);
+			UICV_CHECK(renderer.GetStats().nThreads == nThreads[t]);
+			UICV_CHECK(canvas.Compare(expected) == 0);
+		}
+	}
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "ParallelRenderer.ThreadCountsAreIdentical", TestThreadCountsAreIdentical },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
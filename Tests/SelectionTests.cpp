@@ -0,0 +1,107 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewTest.h"
+#include "UICollectionViewSelection.h"
+
+using namespace DuiLib;
+
+// Create a set of indexes.
+static std::set<int> Indexes(std::initializer_list<int> indexes)
+{
+	return std::set<int>(indexes);
+}
+
+// Without toggling, the selection is the items in the range, cells past the last item are skipped.
+static void TestSelectRange()
+{
+	UICollectionViewRect rcCell = { 2, 1, 2, 1 };
+	UICV_CHECK(UICollectionViewSelection::SelectRange(Indexes({ 0, 3 }), rcCell, 5, 25, false) == Indexes({ 7 }));
+
+	UICollectionViewRect rcBlock = { 1, 3, 3, 4 };
+	UICV_CHECK(UICollectionViewSelection::SelectRange(std::set<int>(), rcBlock, 5, 22, false) == Indexes({ 16, 17, 18, 21 }));
+
+	// nothing is selected by an empty lasso range.
+	UICollectionViewRect rcNone = { -1, -1, -1, -1 };
+	UICV_CHECK(UICollectionViewSelection::SelectRange(Indexes({ 1 }), rcNone, 5, 25, false).empty());
+}
+
+// With toggling, items in the range flip their state in the persisted selection.
+static void TestToggleRange()
+{
+	UICollectionViewRect rcBlock = { 0, 0, 1, 1 };
+	UICV_CHECK(UICollectionViewSelection::SelectRange(Indexes({ 0, 1, 7 }), rcBlock, 5, 25, true) == Indexes({ 5, 6, 7 }));
+
+	// the persisted selection is kept by an empty lasso range.
+	UICollectionViewRect rcNone = { -1, -1, -1, -1 };
+	UICV_CHECK(UICollectionViewSelection::SelectRange(Indexes({ 1, 4 }), rcNone, 5, 25, true) == Indexes({ 1, 4 }));
+}
+
+// All items are selected.
+static void TestSelectAll()
+{
+	UICV_CHECK(UICollectionViewSelection::SelectAll(4) == Indexes({ 0, 1, 2, 3 }));
+	UICV_CHECK(UICollectionViewSelection::SelectAll(0).empty());
+}
+
+// A span selects the items between two indexes in either order.
+static void TestSelectSpan()
+{
+	UICV_CHECK(UICollectionViewSelection::SelectSpan(7, 3) == Indexes({ 3, 4, 5, 6, 7 }));
+	UICV_CHECK(UICollectionViewSelection::SelectSpan(2, 2) == Indexes({ 2 }));
+}
+
+// Removing an item drops its index and shifts greater indexes down.
+static void TestRemoveIndex()
+{
+	std::set<int> sIndexes = Indexes({ 1, 3, 5 });
+	UICollectionViewSelection::RemoveIndex(sIndexes, 3);
+	UICV_CHECK(sIndexes == Indexes({ 1, 4 }));
+
+	sIndexes = Indexes({ 1, 3, 5 });
+	UICollectionViewSelection::RemoveIndex(sIndexes, 2);
+	UICV_CHECK(sIndexes == Indexes({ 1, 2, 4 }));
+
+	sIndexes = Indexes({ 1, 3, 5 });
+	UICollectionViewSelection::RemoveIndex(sIndexes, 9);
+	UICV_CHECK(sIndexes == Indexes({ 1, 3, 5 }));
+}
+
+// Inserting an item shifts indexes from its index on up by 1.
+static void TestInsertIndex()
+{
+	std::set<int> sIndexes = Indexes({ 1, 3, 5 });
+	UICollectionViewSelection::InsertIndex(sIndexes, 3);
+	UICV_CHECK(sIndexes == Indexes({ 1, 4, 6 }));
+
+	sIndexes = Indexes({ 1, 3, 5 });
+	UICollectionViewSelection::InsertIndex(sIndexes, 9);
+	UICV_CHECK(sIndexes == Indexes({ 1, 3, 5 }));
+}
+
+// An item moves by the insertions at or before it and the removals before it.
+static void TestIndexAfterChanges()
+{
+	UICV_CHECK(UICollectionViewSelection::GetIndexAfterInsertion(5, Indexes({ 0, 5, 9 })) == 7);
+	UICV_CHECK(UICollectionViewSelection::GetIndexAfterInsertion(5, Indexes({ 7 })) == 5);
+	UICV_CHECK(UICollectionViewSelection::GetIndexAfterRemoval(5, Indexes({ 0, 5, 9 })) == 4);
+	UICV_CHECK(UICollectionViewSelection::GetIndexAfterRemoval(5, Indexes({ 7 })) == 5);
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "Selection.SelectRange", TestSelectRange },
+		{ "Selection.ToggleRange", TestToggleRange },
+		{ "Selection.SelectAll", TestSelectAll },
+		{ "Selection.SelectSpan", TestSelectSpan },
+		{ "Selection.RemoveIndex", TestRemoveIndex },
+		{ "Selection.InsertIndex", TestInsertIndex },
+		{ "Selection.IndexAfterChanges", TestIndexAfterChanges },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
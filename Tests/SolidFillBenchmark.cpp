@@ -0,0 +1,76 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewTest.h"
+#include "UICollectionViewSolidFill.h"
+
+using namespace DuiLib;
+
+// Fill a page of translucent item backgrounds into a 32bpp DIB section, the way the collection view paints
+// them: the 16 step gradient of identical colors item controls used to paint, a single DrawColor, and the
+// solid fill, each with square and with round corners.
+int main()
+{
+	const int nWidth = 1280, nHeight = 800, nItemSize = 120, nPadding = 8;
+	const DWORD dwColor = 0x6684ACDD;
+
+	BITMAPINFO bmi;
+	memset(&bmi, 0, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = nWidth;
+	bmi.bmiHeader.biHeight = -nHeight;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void *pBits = nullptr;
+	HDC hDC = ::CreateCompatibleDC(NULL);
+	HBITMAP hBitmap = ::CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
+	if (!hDC || !hBitmap) return 1;
+	HBITMAP hOldBitmap = (HBITMAP)::SelectObject(hDC, hBitmap);
+
+	// visit every item of the page with a paint function.
+	auto PaintPage = [&](const std::function<void(const RECT &)> &fnPaint) {
+		for (int y = nPadding; y + nItemSize <= nHeight; y += nItemSize + nPadding) {
+			for (int x = nPadding; x + nItemSize <= nWidth; x += nItemSize + nPadding) {
+				RECT rcItem = { x, y, x + nItemSize, y + nItemSize };
+				fnPaint(rcItem);
+			}
+		}
+		::GdiFlush();
+	};
+
+	struct Case {
+		const char *pstrName;
+		std::function<void(const RECT &)> fnPaint;
+	};
+	Case cases[] = {
+		{ "gradient", [&](const RECT &rc) { CRenderEngine::DrawGradient(hDC, rc, dwColor, dwColor, true, 16); } },
+		{ "drawcolor", [&](const RECT &rc) { CRenderEngine::DrawColor(hDC, rc, dwColor); } },
+		{ "solidfill", [&](const RECT &rc) { UICollectionViewSolidFill::Fill(hDC, rc, dwColor); } },
+		{ "round drawcolor", [&](const RECT &rc) {
+			CRenderClip clip;
+			CRenderClip::GenerateRoundClip(hDC, rc, rc, 3, 3, clip);
+			CRenderEngine::DrawColor(hDC, rc, dwColor);
+		} },
+		{ "round solidfill", [&](const RECT &rc) { UICollectionViewSolidFill::FillRound(hDC, rc, rc, 3, 3, dwColor); } },
+	};
+
+	double fBaseline = 0;
+	printf("%dx%d page of %dpx items\n", nWidth, nHeight, nItemSize);
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i ++) {
+		double fMicroseconds = UICollectionViewMeasure([&]() { PaintPage(cases[i].fnPaint); });
+		if (i == 0) fBaseline = fMicroseconds;
+		printf("%-16s %10.1f us %6.2fx\n", cases[i].pstrName, fMicroseconds, fBaseline / fMicroseconds);
+	}
+
+	::SelectObject(hDC, hOldBitmap);
+	::DeleteObject(hBitmap);
+	::DeleteDC(hDC);
+	return 0;
+}
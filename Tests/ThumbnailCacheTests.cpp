@@ -0,0 +1,93 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewTest.h"
+#include "UICollectionViewThumbnailCache.h"
+#include <vector>
+
+using namespace DuiLib;
+
+// 64x64 thumbnails take 16KB, a 1MB budget sizes pages to 64KB, i.e. 16 pages of 2x2 slots.
+static const SIZE_T nBudget = 1024 * 1024;
+static const SIZE szThumbnail = { 64, 64 };
+
+// Decode a packed thumbnail for an index and insert it, return the cached thumbnail.
+static UICollectionViewThumbnailPtr InsertThumbnail(UICollectionViewThumbnailCache &cache, int nIndex)
+{
+	TCHAR szIdentifier[32];
+	_stprintf_s(szIdentifier, _T("item-%d"), nIndex);
+	return cache.Insert(szIdentifier, szThumbnail, cache.CreateThumbnail(szThumbnail));
+}
+
+// Return true if the thumbnail of an index is cached.
+static bool IsCached(UICollectionViewThumbnailCache &cache, int nIndex)
+{
+	TCHAR szIdentifier[32];
+	_stprintf_s(szIdentifier, _T("item-%d"), nIndex);
+	return cache.Lookup(szIdentifier, szThumbnail) != nullptr;
+}
+
+// Unpinned pages are evicted as a whole, the cache stays under budget with its pages full.
+static void TestEvictPages()
+{
+	UICollectionViewThumbnailCache cache(nBudget);
+	cache.SetPackingEnabled(TRUE);
+	for (int i = 0; i < 200; i ++) InsertThumbnail(cache, i);
+
+	UICollectionViewThumbnailCacheStats stats = cache.GetStats();
+	UICV_CHECK(stats.nBytes <= nBudget);
+	UICV_CHECK(stats.nAtlasPages <= 16);
+	UICV_CHECK(stats.nCount >= 60);
+	UICV_CHECK(IsCached(cache, 199) && !IsCached(cache, 0));
+}
+
+// Pages of displayed thumbnails can't be freed, the cache stays over budget instead of evicting everything else.
+static void TestPinnedPages()
+{
+	UICollectionViewThumbnailCache cache(nBudget);
+	cache.SetPackingEnabled(TRUE);
+	std::vector<UICollectionViewThumbnailPtr> displayed;
+	for (int i = 0; i < 80; i ++) displayed.push_back(InsertThumbnail(cache, i));
+
+	UICollectionViewThumbnailCacheStats stats = cache.GetStats();
+	UICV_CHECK(stats.nBytes > nBudget);
+	UICV_CHECK(stats.nCount == 80);
+	UICV_CHECK(stats.nEvictions == 0);
+
+	// once the item views release them, the least recently used pages are evicted.
+	displayed.clear();
+	InsertThumbnail(cache, 80);
+	stats = cache.GetStats();
+	UICV_CHECK(stats.nBytes <= nBudget);
+	UICV_CHECK(stats.nCount >= 60);
+}
+
+// A pinned page survives while the rest of the cache is cycled through.
+static void TestPinnedPageSurvives()
+{
+	UICollectionViewThumbnailCache cache(nBudget);
+	cache.SetPackingEnabled(TRUE);
+	std::vector<UICollectionViewThumbnailPtr> displayed;
+	for (int i = 0; i < 4; i ++) displayed.push_back(InsertThumbnail(cache, i));
+	for (int i = 4; i < 400; i ++) InsertThumbnail(cache, i);
+
+	UICollectionViewThumbnailCacheStats stats = cache.GetStats();
+	UICV_CHECK(stats.nBytes <= nBudget);
+	UICV_CHECK(stats.nCount >= 60);
+	for (int i = 0; i < 4; i ++) UICV_CHECK(IsCached(cache, i));
+}
+
+int main()
+{
+	static const UICollectionViewTest tests[] = {
+		{ "ThumbnailCache.EvictPages", TestEvictPages },
+		{ "ThumbnailCache.PinnedPages", TestPinnedPages },
+		{ "ThumbnailCache.PinnedPageSurvives", TestPinnedPageSurvives },
+	};
+	return UICollectionViewRunTests(tests, sizeof(tests) / sizeof(tests[0]));
+}
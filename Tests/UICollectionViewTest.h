@@ -0,0 +1,66 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+
+// A minimal test harness, so the tests build anywhere without third party frameworks. A test is a
+// function which checks its expectations with `UICV_CHECK`, `UICollectionViewRunTests` runs them
+// and returns the exit code of the test executable.
+
+// Failed checks of the running test.
+static int g_nCheckFailures = 0;
+
+// Report a failed expectation and continue with the test.
+#define UICV_CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			printf("  %s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); \
+			g_nCheckFailures ++; \
+		} \
+	} while (0)
+
+// A named test.
+struct UICollectionViewTest
+{
+	const char *pstrName;
+	void (*pfnTest)();
+};
+
+// Run the tests, return 0 if all of them pass.
+inline int UICollectionViewRunTests(const UICollectionViewTest *pTests, int nCount)
+{
+	int nFailed = 0;
+	for (int i = 0; i < nCount; i ++) {
+		g_nCheckFailures = 0;
+		pTests[i].pfnTest();
+		printf("%s %s\n", g_nCheckFailures ? "FAIL" : "ok  ", pTests[i].pstrName);
+		if (g_nCheckFailures) nFailed ++;
+	}
+	printf("%d of %d tests passed\n", nCount - nFailed, nCount);
+	return nFailed ? 1 : 0;
+}
+
+// Run `fn` repeatedly for about `nMilliseconds`, return the average time per run in microseconds.
+inline double UICollectionViewMeasure(const std::function<void()> &fn, int nMilliseconds = 200)
+{
+	typedef std::chrono::steady_clock Clock;
+	fn(); // warm up.
+
+	int nRuns = 0;
+	Clock::time_point tpStart = Clock::now();
+	Clock::duration elapsed;
+	do {
+		fn();
+		nRuns ++;
+		elapsed = Clock::now() - tpStart;
+	} while (elapsed < std::chrono::milliseconds(nMilliseconds));
+	return std::chrono::duration<double, std::micro>(elapsed).count() / nRuns;
+}
@@ -21,9 +21,15 @@ UICollectionView::UICollectionView()
 }
 
 // By default refresh internal cache and rebuild the whole view.
-void UICollectionView::ReloadData(BOOL bFullReload)
+void UICollectionView::ReloadData(BOOL bFullReload, BOOL bKeepState)
 {
-	m_pContentView->ReloadData(bFullReload);
+	m_pContentView->ReloadData(bFullReload, bKeepState);
+}
+
+// Fill items at the indexes again via delegate.
+void UICollectionView::ReloadItemsAtIndexes(const std::set<int> &sIndexes)
+{
+	m_pContentView->ReloadItemsAtIndexes(sIndexes);
 }
 
 // Remove item at particular index.
@@ -46,6 +52,20 @@ void UICollectionView::RemoveAll()
 	m_pContentView->RemoveAll();
 }
 
+// Insert an item at particular index.
+bool UICollectionView::InsertAt(int nIndex)
+{
+	std::set<int> sIndexes;
+	sIndexes.insert(nIndex);
+	return InsertAt(sIndexes);
+}
+
+// Insert items at the indexes, numbered after the insertion.
+bool UICollectionView::InsertAt(std::set<int> sIndexes)
+{
+	return m_pContentView->InsertAt(sIndexes);
+}
+
 // Return the item selection indexes.
 std::set<int> UICollectionView::GetSelectionIndexes() const
 {
@@ -58,6 +78,66 @@ UICollectionViewDelegate* UICollectionView::GetDelegate() const
 	return m_pContentView->GetDelegate();
 }
 
+// Get the thumbnail cache.
+UICollectionViewThumbnailCache* UICollectionView::GetThumbnailCache() const
+{
+	return m_pContentView->GetThumbnailCache();
+}
+
+// Get the thumbnail store.
+UICollectionViewThumbnailStore* UICollectionView::GetThumbnailStore() const
+{
+	return m_pContentView->GetThumbnailStore();
+}
+
+// Get the smoothed scroll velocity.
+double UICollectionView::GetScrollVelocity() const
+{
+	return m_pContentView->GetScrollVelocity();
+}
+
+// Get the tile cache.
+UICollectionViewTileCache* UICollectionView::GetTileCache() const
+{
+	return m_pContentView->GetTileCache();
+}
+
+// Queue a low priority job.
+void UICollectionView::PostIdleJob(const UICollectionViewIdleScheduler::Job &job)
+{
+	m_pContentView->PostIdleJob(job);
+}
+
+// Repaint an item.
+void UICollectionView::InvalidateItemAtIndex(int nIndex)
+{
+	m_pContentView->InvalidateItemAtIndex(nIndex);
+}
+
+// Get counters of items scrolled into view.
+UICollectionViewReuseStats UICollectionView::GetReuseStats() const
+{
+	return m_pContentView->GetReuseStats();
+}
+
+// Reset counters of reused items.
+void UICollectionView::ResetReuseStats()
+{
+	m_pContentView->ResetReuseStats();
+}
+
+// Get counters of item invalidations added and invalidated on screen after merging.
+UICollectionViewDirtyRectStats UICollectionView::GetDirtyRectStats() const
+{
+	return m_pContentView->GetDirtyRectStats();
+}
+
+// Reset counters of item invalidations.
+void UICollectionView::ResetDirtyRectStats()
+{
+	m_pContentView->ResetDirtyRectStats();
+}
+
 // Set the delegate.
 void UICollectionView::SetDelegate(UICollectionViewDelegate *pDelegate)
 {
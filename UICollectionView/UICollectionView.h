@@ -9,6 +9,10 @@
 
 #include "UICollectionViewItem.h"
 #include "UICollectionViewDelegate.h"
+#include "UICollectionViewThumbnailCache.h"
+#include "UICollectionViewThumbnailStore.h"
+#include "UICollectionViewTileCache.h"
+#include "UICollectionViewIdleScheduler.h"
 
 namespace DuiLib
 {
@@ -40,13 +44,30 @@ public:
 	// However, sometimes you are very sure that you haven't made any changes to the data source, and you want to update
 	// the item layout for some reason (e.g. zoom in & out items), in this case, we recommend you to disable full reload
 	// as it will ideally result a better performance.
-	void ReloadData(BOOL bFullReload = TRUE);
+	// If the data changed but you want to keep the user's context, e.g. counts are refreshed periodically, set
+	// `bKeepState` with a full reload: the scroll pos is kept (clamped to the new content), selections are kept for indexes
+	// which still exist, and only visible items at valid indexes are filled again.
+	void ReloadData(BOOL bFullReload = TRUE, BOOL bKeepState = FALSE);
 
 	// UICollection allows you to configure UI appearance by using the following attributes:
 	// - itemsize / itempadding: Item size and padding between them, you can also specify them via delegate methods.
 	// - itembkcolor / itemselectedbkcolor / itemhotbkcolor / itemdisabledbkcolor: Item background color.
 	// - itembordersize / itembordercolor / itemselectedbordercolor / itemhotbordercolor / itemdisabledbordercolor: Item border size & color.
 	// - lassobkcolor / lassobordercolor / lassobordersize: Apperance of drag selection lasso view.
+	// - thumbnailcachesize: Memory budget of the thumbnail cache in megabytes.
+	// - thumbnailatlas: Pack cached thumbnails of the same size into shared atlas pages.
+	// - itemqualityvelocity: Scroll velocities (pixels per second) above which items are filled at low quality and with
+	//   placeholders, e.g. "3000,12000", zero disables a level. See `CollectionViewWillDisplayItemWithQuality`.
+	// - itemdwelltime / itemskeletoncolor: Milliseconds items appearing while scrolling are painted as skeletons before
+	//   they are bound and filled via delegate, zero (default) disables it; and the color of the skeletons.
+	// - recyclehysteresis: Pixels items are kept outside of the viewport before being recycled, twice as many behind the
+	//   scroll direction as ahead of it, so touchpad jitter around a row boundary doesn't recycle them over and over.
+	// - idleslicetime: Milliseconds idle jobs may run at a time, see `PostIdleJob`.
+	// - itembindbudget: Milliseconds a layout pass may spend binding newly visible items, nearest to the center first.
+	//   Items over the budget are painted as skeletons and bound in the following frames, zero (default) disables it.
+	// - scrollblit: Scroll by shifting the pixels on screen and only repaint the exposed strip. Use it with a solid
+	//   background, a background image would be shifted along with the items.
+	// - tilecache / tilecachesize: Paint through cached tiles of the content, and their memory budget in megabytes.
 	//
 	// UICollection also disabled the following existed attributes thus you should not use:
 	// - hscrollbar / hscrollbarstyle: Horizontal scrolling is not supported.
@@ -74,12 +95,60 @@ public:
 	// Remove all items.
 	void RemoveAll();
 
+	// Insert an item at particular index, the data source must already contain it. Items shown keep their place on screen.
+	bool InsertAt(int nIndex);
+
+	// Insert items at the indexes, numbered after the insertion. The data source must already contain them.
+	bool InsertAt(std::set<int> sIndexes);
+
+	// When only the data of some items changed, e.g. metadata updates, reload them instead of all the data. Visible items
+	// at the indexes are filled again via `CollectionViewWillDisplayItem`, the others when they are scrolled in. The count
+	// of items must not change, use the `Remove` methods or `ReloadData()` for that.
+	void ReloadItemsAtIndexes(const std::set<int> &sIndexes);
+
 	// Return the item selection indexes.
 	std::set<int> GetSelectionIndexes() const;
 
 	// Get the delegate.
 	UICollectionViewDelegate* GetDelegate() const;
 
+	// The thumbnail cache keeps decoded item images across recycling, check it in `CollectionViewWillDisplayItem`
+	// before decoding an image, and insert the decoded one on a miss.
+	UICollectionViewThumbnailCache* GetThumbnailCache() const;
+
+	// The thumbnail store persists thumbnails in a memory-mapped file, it is closed until you open it with a file path.
+	// On a cache miss, look the thumbnail up in the store with the source timestamp before decoding, so the first screen
+	// of a warm restart is painted from the stored pixels directly.
+	UICollectionViewThumbnailStore* GetThumbnailStore() const;
+
+	// Get the smoothed scroll velocity in pixels per second, zero once scrolling settles.
+	double GetScrollVelocity() const;
+
+	// The tile cache is the backing store of painted items when the `tilecache` attribute is set. Cached tiles are invalidated
+	// when an item is displayed, hovered or (de)selected; if you change an item's content at another time, call its
+	// `Invalidate()` so the tiles under it are repainted.
+	UICollectionViewTileCache* GetTileCache() const;
+
+	// Queue a low priority job, e.g. prefetching thumbnails of the next page. It runs while no input or paint message is
+	// waiting, do a small unit of work until the scheduler `ShouldYield()`, and return true if the job has work left.
+	void PostIdleJob(const UICollectionViewIdleScheduler::Job &job);
+
+	// Repaint an item, e.g. its data changed outside of the delegate methods. In immediate mode this is the way to update
+	// an item, e.g. once its thumbnail is loaded.
+	void InvalidateItemAtIndex(int nIndex);
+
+	// Get counters of items scrolled into view: handed back still bound to their index, or filled via delegate.
+	UICollectionViewReuseStats GetReuseStats() const;
+
+	// Reset counters of reused items.
+	void ResetReuseStats();
+
+	// Get counters of item invalidations added and invalidated on screen after merging.
+	UICollectionViewDirtyRectStats GetDirtyRectStats() const;
+
+	// Reset counters of item invalidations.
+	void ResetDirtyRectStats();
+
 	// Set the delegate.
 	void SetDelegate(UICollectionViewDelegate* pDelegate);
 
@@ -0,0 +1,74 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewBindQueue.h"
+
+namespace DuiLib
+{
+
+// Constructor.
+UICollectionViewBindQueue::UICollectionViewBindQueue()
+	:m_uDwellTime(0), m_uBudget(0), m_uNow(0), m_bScrolling(false)
+{
+}
+
+// Start a layout pass of the visible index range.
+void UICollectionViewBindQueue::BeginPass(int nFirst, int nLast, uint32_t uNow, bool bScrolling)
+{
+	m_uNow = uNow;
+	m_bScrolling = bScrolling;
+
+	// forget pending items scrolled out before their dwell time.
+	for (auto itr = m_Pending.begin(); itr != m_Pending.end();) {
+		if (itr->first < nFirst || itr->first > nLast) itr = m_Pending.erase(itr);
+		else itr ++;
+	}
+}
+
+// Decide an unbound visible item of the current pass.
+UICollectionViewBindQueue::Action UICollectionViewBindQueue::Decide(int nIndex, double fElapsed)
+{
+	// items appearing while scrolling are bound only once they stay visible, e.g. not while the thumb is dragged.
+	auto pending = m_Pending.find(nIndex);
+	if (pending == m_Pending.end() && m_bScrolling && m_uDwellTime > 0) {
+		m_Pending[nIndex] = m_uNow;
+		return ActionDefer;
+	}
+	if (pending != m_Pending.end() && m_uNow - pending->second < m_uDwellTime) return ActionWait;
+
+	// items over the bind budget of this pass are due in the next one.
+	if (m_uBudget > 0 && fElapsed >= m_uBudget) {
+		bool bNew = pending == m_Pending.end();
+		m_Pending[nIndex] = m_uNow - m_uDwellTime;
+		return bNew ? ActionDefer : ActionWait;
+	}
+
+	if (pending == m_Pending.end()) return ActionBind;
+	m_Pending.erase(pending);
+	return ActionBindPending;
+}
+
+// Get the milliseconds from the start of the current pass until pending items are due.
+int UICollectionViewBindQueue::GetNextDelay() const
+{
+	if (m_Pending.empty()) return -1;
+
+	// the oldest pending item is due first, those over budget are due at once.
+	uint32_t uElapsed = 0;
+	for (auto itr = m_Pending.begin(); itr != m_Pending.end(); itr ++) {
+		if (m_uNow - itr->second > uElapsed) uElapsed = m_uNow - itr->second;
+	}
+	return uElapsed < m_uDwellTime ? (int)(m_uDwellTime - uElapsed) : 1;
+}
+
+// Forget pending indexes from the index on.
+void UICollectionViewBindQueue::RemoveFrom(int nIndex)
+{
+	m_Pending.erase(m_Pending.lower_bound(nIndex), m_Pending.end());
+}
+
+}
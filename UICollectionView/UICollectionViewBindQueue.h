@@ -0,0 +1,80 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+
+namespace DuiLib
+{
+
+// Decides when visible items without an item control are bound. Items appearing while scrolling stay
+// skeletons until they have been visible for the dwell time, and items over the bind budget of a layout
+// pass stay skeletons until the next pass. Pending items are due after `GetNextDelay()`, the caller has
+// to repaint them by then, so a layout pass runs and binds them. Times are ticks in milliseconds, which
+// may wrap around.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewBindQueue
+{
+public:
+
+	// What to do with an unbound visible item.
+	enum Action {
+		ActionBind,			// bind it now.
+		ActionBindPending,	// bind it now, it was painted as a skeleton so it has to be repainted.
+		ActionDefer,		// keep it a skeleton, it just became pending so it has to be repainted as one.
+		ActionWait,			// keep it a skeleton, it is pending already.
+	};
+
+	// Constructor.
+	UICollectionViewBindQueue();
+
+	// Get the milliseconds items appearing while scrolling stay skeletons.
+	uint32_t GetDwellTime() const { return m_uDwellTime; }
+
+	// Set the milliseconds items appearing while scrolling stay skeletons, zero disables.
+	void SetDwellTime(uint32_t uDwellTime) { m_uDwellTime = uDwellTime; }
+
+	// Get the milliseconds a layout pass may spend binding items.
+	uint32_t GetBudget() const { return m_uBudget; }
+
+	// Set the milliseconds a layout pass may spend binding items, zero disables.
+	void SetBudget(uint32_t uBudget) { m_uBudget = uBudget; }
+
+	// Start a layout pass of the visible index range, pending items scrolled out are forgotten.
+	void BeginPass(int nFirst, int nLast, uint32_t uNow, bool bScrolling);
+
+	// Decide an unbound visible item of the current pass, `fElapsed` is the milliseconds spent binding so far.
+	Action Decide(int nIndex, double fElapsed);
+
+	// Get the milliseconds from the start of the current pass until pending items are due, -1 if none is pending.
+	int GetNextDelay() const;
+
+	// Return true if the item at the index is painted as a skeleton.
+	bool IsPending(int nIndex) const { return m_Pending.count(nIndex) != 0; }
+
+	// Get the pending indexes and the tick they became pending.
+	const std::map<int, uint32_t>& GetPending() const { return m_Pending; }
+
+	// Forget pending indexes from the index on, e.g. items were removed.
+	void RemoveFrom(int nIndex);
+
+	// Forget all pending indexes.
+	void Clear() { m_Pending.clear(); }
+
+private:
+
+	uint32_t m_uDwellTime; // milliseconds items appearing while scrolling stay skeletons.
+	uint32_t m_uBudget; // milliseconds a layout pass may spend binding items.
+	uint32_t m_uNow; // tick of the current pass.
+	bool m_bScrolling; // the current pass is scrolling.
+	std::map<int, uint32_t> m_Pending; // visible items painted as skeletons, and the tick they appeared.
+};
+
+}
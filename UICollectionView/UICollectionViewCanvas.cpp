@@ -0,0 +1,293 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewCanvas.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define UICOLLECTIONVIEW_X86
+#include <emmintrin.h>
+#endif
+
+namespace DuiLib
+{
+
+// Divide a product of two channels by 255, rounded, exact for all products.
+static inline uint32_t Div255(uint32_t nValue)
+{
+	nValue += 128;
+	return (nValue + (nValue >> 8)) >> 8;
+}
+
+// Blend a premultiplied pixel over another one.
+static inline uint32_t BlendPixel(uint32_t uDst, uint32_t uSrc)
+{
+	uint32_t uInverse = 255 - (uSrc >> 24);
+	uint32_t uPixel = 0;
+	for (int nShift = 0; nShift < 32; nShift += 8) {
+		uint32_t c = ((uSrc >> nShift) & 0xFF) + Div255(((uDst >> nShift) & 0xFF) * uInverse);
+		uPixel |= (c > 255 ? 255 : c) << nShift;
+	}
+	return uPixel;
+}
+
+// Constructor, allocate a transparent canvas.
+UICollectionViewCanvas::UICollectionViewCanvas(int nWidth, int nHeight)
+	:m_nWidth(nWidth > 0 ? nWidth : 0), m_nHeight(nHeight > 0 ? nHeight : 0), m_nStride(m_nWidth), m_pBits(NULL)
+{
+	m_Buffer.resize((size_t)m_nWidth * m_nHeight + 1, 0);
+	m_pBits = &m_Buffer[0];
+	ResetClip();
+}
+
+// Constructor, wrap pixels owned by the caller.
+UICollectionViewCanvas::UICollectionViewCanvas(uint32_t *pBits, int nWidth, int nHeight, int nStride)
+	:m_nWidth(pBits && nWidth > 0 ? nWidth : 0), m_nHeight(pBits && nHeight > 0 ? nHeight : 0), m_nStride(nStride), m_pBits(pBits)
+{
+	ResetClip();
+}
+
+// Get a pixel, zero if it is out of the canvas.
+uint32_t UICollectionViewCanvas::GetPixel(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= m_nWidth || y >= m_nHeight) return 0;
+	return GetRow(y)[x];
+}
+
+// Restrict painting to a rect within the canvas.
+void UICollectionViewCanvas::SetClip(const Rect &rc)
+{
+	ResetClip();
+	if (!Crop(rc, m_rcClip)) {
+		Rect rcEmpty = { 0, 0, 0, 0 };
+		m_rcClip = rcEmpty;
+	}
+}
+
+// Allow painting onto the whole canvas.
+void UICollectionViewCanvas::ResetClip()
+{
+	Rect rcCanvas = { 0, 0, m_nWidth, m_nHeight };
+	m_rcClip = rcCanvas;
+}
+
+// Replace the pixels within the clip with a premultiplied color.
+void UICollectionViewCanvas::Clear(uint32_t uColor)
+{
+	for (int y = m_rcClip.top; y < m_rcClip.bottom; y ++) {
+		uint32_t *pRow = GetRow(y);
+		for (int x = m_rcClip.left; x < m_rcClip.right; x ++) {
+			pRow[x] = uColor;
+		}
+	}
+}
+
+// Blend an ARGB color over a rect.
+void UICollectionViewCanvas::FillRect(const Rect &rc, uint32_t dwColor)
+{
+	Rect rcFill;
+	if (!Crop(rc, rcFill)) return;
+	FillPixels(GetRow(rcFill.top) + rcFill.left, rcFill.right - rcFill.left, rcFill.bottom - rcFill.top, m_nStride, dwColor);
+}
+
+// Blend an ARGB border of the width inside a rect, corners are blended once.
+void UICollectionViewCanvas::DrawBorder(const Rect &rc, int nBorderWidth, uint32_t dwColor)
+{
+	if (nBorderWidth <= 0 || rc.right <= rc.left || rc.bottom <= rc.top) return;
+
+	// top and bottom edges span the whole width, left and right edges fill the rows in between.
+	int nHorizontal = std::min(nBorderWidth, (rc.bottom - rc.top + 1) / 2);
+	int nVertical = std::min(nBorderWidth, (rc.right - rc.left + 1) / 2);
+	Rect rcTop = { rc.left, rc.top, rc.right, rc.top + nHorizontal };
+	Rect rcBottom = { rc.left, std::max(rcTop.bottom, rc.bottom - nHorizontal), rc.right, rc.bottom };
+	Rect rcLeft = { rc.left, rcTop.bottom, rc.left + nVertical, rcBottom.top };
+	Rect rcRight = { std::max(rcLeft.right, rc.right - nVertical), rcTop.bottom, rc.right, rcBottom.top };
+	FillRect(rcTop, dwColor);
+	FillRect(rcBottom, dwColor);
+	FillRect(rcLeft, dwColor);
+	FillRect(rcRight, dwColor);
+}
+
+// Blend a premultiplied BGRA image over a rect, it is resampled if the sizes differ.
+bool UICollectionViewCanvas::DrawImage(const Rect &rc, const uint32_t *pSrc, int nSrcWidth, int nSrcHeight, int nSrcStride,
+	UICollectionViewImageScaler::Filter filter)
+{
+	if (!pSrc || nSrcWidth <= 0 || nSrcHeight <= 0 || nSrcStride < nSrcWidth) return false;
+
+	Rect rcDraw;
+	if (!Crop(rc, rcDraw)) return true;
+
+	// resample the whole image to the rect once, then blend the visible part.
+	int nWidth = rc.right - rc.left;
+	int nHeight = rc.bottom - rc.top;
+	std::vector<uint32_t> Scaled;
+	if (nWidth != nSrcWidth || nHeight != nSrcHeight) {
+		Scaled.resize((size_t)nWidth * nHeight);
+		if (!UICollectionViewImageScaler::Scale(pSrc, nSrcWidth, nSrcHeight, nSrcStride, &Scaled[0], nWidth, nHeight, nWidth, filter))
+			return false;
+		pSrc = &Scaled[0];
+		nSrcStride = nWidth;
+	}
+
+	BlendPixels(GetRow(rcDraw.top) + rcDraw.left, m_nStride, pSrc + (ptrdiff_t)(rcDraw.top - rc.top) * nSrcStride + (rcDraw.left - rc.left),
+		nSrcStride, rcDraw.right - rcDraw.left, rcDraw.bottom - rcDraw.top);
+	return true;
+}
+
+// Count pixels differing from another canvas by more than the tolerance in any channel.
+int UICollectionViewCanvas::Compare(const UICollectionViewCanvas &canvas, int nTolerance) const
+{
+	if (canvas.m_nWidth != m_nWidth || canvas.m_nHeight != m_nHeight) return -1;
+
+	int nDiffer = 0;
+	for (int y = 0; y < m_nHeight; y ++) {
+		const uint32_t *pRow = GetRow(y);
+		const uint32_t *pOther = canvas.GetRow(y);
+		for (int x = 0; x < m_nWidth; x ++) {
+			if (pRow[x] == pOther[x]) continue;
+			for (int nShift = 0; nShift < 32; nShift += 8) {
+				if (abs((int)((pRow[x] >> nShift) & 0xFF) - (int)((pOther[x] >> nShift) & 0xFF)) > nTolerance) {
+					nDiffer ++;
+					break;
+				}
+			}
+		}
+	}
+	return nDiffer;
+}
+
+// Save the pixels as a top-down 32bpp BMP file.
+bool UICollectionViewCanvas::SaveBitmap(const char *pszPath) const
+{
+	std::ofstream file(pszPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+
+	// BITMAPFILEHEADER and BITMAPINFOHEADER, little endian, a negative height for top-down rows.
+	uint32_t nImageSize = (uint32_t)m_nWidth * m_nHeight * 4;
+	uint8_t header[54] = { 'B', 'M' };
+	auto Put = [&header](int nOffset, uint32_t nValue, int nBytes) {
+		for (int i = 0; i < nBytes; i ++) header[nOffset + i] = (uint8_t)(nValue >> (i * 8));
+	};
+	Put(2, 54 + nImageSize, 4);
+	Put(10, 54, 4);
+	Put(14, 40, 4);
+	Put(18, (uint32_t)m_nWidth, 4);
+	Put(22, (uint32_t)-m_nHeight, 4);
+	Put(26, 1, 2);
+	Put(28, 32, 2);
+	Put(34, nImageSize, 4);
+	file.write((const char *)header, sizeof(header));
+
+	for (int y = 0; y < m_nHeight; y ++) {
+		file.write((const char *)GetRow(y), (std::streamsize)m_nWidth * 4);
+	}
+	return file.good();
+}
+
+// Blend an ARGB color over 32bpp premultiplied BGRA pixels.
+void UICollectionViewCanvas::FillPixels(uint32_t *pBits, int nWidth, int nHeight, int nStride, uint32_t dwColor)
+{
+	uint32_t a = dwColor >> 24;
+	if (a == 0 || nWidth <= 0 || nHeight <= 0) return;
+
+	// premultiply the color once, dst = src + dst * (255 - a) / 255.
+	uint32_t uInverse = 255 - a;
+	uint32_t uColor = (a << 24) | (Div255(((dwColor >> 16) & 0xFF) * a) << 16)
+		| (Div255(((dwColor >> 8) & 0xFF) * a) << 8) | Div255((dwColor & 0xFF) * a);
+
+#ifdef UICOLLECTIONVIEW_X86
+	__m128i vColor = _mm_set1_epi32((int)uColor);
+	__m128i vInverse = _mm_set1_epi16((short)uInverse);
+	__m128i vRound = _mm_set1_epi16(128);
+	__m128i vZero = _mm_setzero_si128();
+#endif
+
+	for (int y = 0; y < nHeight; y ++) {
+		uint32_t *pRow = pBits + (ptrdiff_t)y * nStride;
+		int x = 0;
+
+		// opaque colors simply replace the pixels.
+		if (a == 255) {
+#ifdef UICOLLECTIONVIEW_X86
+			for (; x + 4 <= nWidth; x += 4) {
+				_mm_storeu_si128((__m128i *)(pRow + x), vColor);
+			}
+#endif
+			for (; x < nWidth; x ++) {
+				pRow[x] = uColor;
+			}
+			continue;
+		}
+
+#ifdef UICOLLECTIONVIEW_X86
+		// 4 pixels at a time, channels are widened to 16 bits for the multiply.
+		for (; x + 4 <= nWidth; x += 4) {
+			__m128i vDst = _mm_loadu_si128((const __m128i *)(pRow + x));
+			__m128i vLo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(vDst, vZero), vInverse), vRound);
+			__m128i vHi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(vDst, vZero), vInverse), vRound);
+			vLo = _mm_srli_epi16(_mm_add_epi16(vLo, _mm_srli_epi16(vLo, 8)), 8);
+			vHi = _mm_srli_epi16(_mm_add_epi16(vHi, _mm_srli_epi16(vHi, 8)), 8);
+			_mm_storeu_si128((__m128i *)(pRow + x), _mm_adds_epu8(_mm_packus_epi16(vLo, vHi), vColor));
+		}
+#endif
+
+		for (; x < nWidth; x ++) {
+			pRow[x] = BlendPixel(pRow[x], uColor);
+		}
+	}
+}
+
+// Blend premultiplied BGRA pixels over other ones.
+void UICollectionViewCanvas::BlendPixels(uint32_t *pDst, int nDstStride, const uint32_t *pSrc, int nSrcStride, int nWidth, int nHeight)
+{
+#ifdef UICOLLECTIONVIEW_X86
+	__m128i vMax = _mm_set1_epi16(255);
+	__m128i vRound = _mm_set1_epi16(128);
+	__m128i vZero = _mm_setzero_si128();
+#endif
+
+	for (int y = 0; y < nHeight; y ++) {
+		uint32_t *pDstRow = pDst + (ptrdiff_t)y * nDstStride;
+		const uint32_t *pSrcRow = pSrc + (ptrdiff_t)y * nSrcStride;
+		int x = 0;
+
+#ifdef UICOLLECTIONVIEW_X86
+		// 4 pixels at a time, the alpha of each source pixel is broadcast to its channels.
+		for (; x + 4 <= nWidth; x += 4) {
+			__m128i vSrc = _mm_loadu_si128((const __m128i *)(pSrcRow + x));
+			__m128i vDst = _mm_loadu_si128((const __m128i *)(pDstRow + x));
+			__m128i vSrcLo = _mm_unpacklo_epi8(vSrc, vZero);
+			__m128i vSrcHi = _mm_unpackhi_epi8(vSrc, vZero);
+			__m128i vInverseLo = _mm_sub_epi16(vMax, _mm_shufflehi_epi16(_mm_shufflelo_epi16(vSrcLo, 0xFF), 0xFF));
+			__m128i vInverseHi = _mm_sub_epi16(vMax, _mm_shufflehi_epi16(_mm_shufflelo_epi16(vSrcHi, 0xFF), 0xFF));
+			__m128i vLo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(vDst, vZero), vInverseLo), vRound);
+			__m128i vHi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(vDst, vZero), vInverseHi), vRound);
+			vLo = _mm_srli_epi16(_mm_add_epi16(vLo, _mm_srli_epi16(vLo, 8)), 8);
+			vHi = _mm_srli_epi16(_mm_add_epi16(vHi, _mm_srli_epi16(vHi, 8)), 8);
+			_mm_storeu_si128((__m128i *)(pDstRow + x), _mm_adds_epu8(_mm_packus_epi16(vLo, vHi), vSrc));
+		}
+#endif
+
+		for (; x < nWidth; x ++) {
+			pDstRow[x] = BlendPixel(pDstRow[x], pSrcRow[x]);
+		}
+	}
+}
+
+// Crop a rect with the clip, return false if nothing is left.
+bool UICollectionViewCanvas::Crop(const Rect &rc, Rect &rcCropped) const
+{
+	rcCropped.left = std::max(rc.left, m_rcClip.left);
+	rcCropped.top = std::max(rc.top, m_rcClip.top);
+	rcCropped.right = std::min(rc.right, m_rcClip.right);
+	rcCropped.bottom = std::min(rc.bottom, m_rcClip.bottom);
+	return rcCropped.left < rcCropped.right && rcCropped.top < rcCropped.bottom;
+}
+
+}
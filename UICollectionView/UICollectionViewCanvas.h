@@ -0,0 +1,107 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UICollectionViewGeometry.h"
+#include "UICollectionViewImageScaler.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace DuiLib
+{
+
+// A software render target of 32bpp premultiplied BGRA pixels, with the primitives the collection view
+// paints with: translucent fills of item and lasso backgrounds, borders and preview images. It needs no
+// HDC or window, so frames can be rendered headless, e.g. for golden image comparisons and frame time
+// measurements in CI, and it can also wrap the bits of a DIB section to paint into it directly.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewCanvas
+{
+public:
+
+	// A rect in pixels.
+	typedef UICollectionViewRect Rect;
+
+	// Constructor, allocate a transparent canvas.
+	UICollectionViewCanvas(int nWidth, int nHeight);
+
+	// Constructor, wrap pixels owned by the caller, the stride is in pixels and negative for bottom-up bitmaps.
+	UICollectionViewCanvas(uint32_t *pBits, int nWidth, int nHeight, int nStride);
+
+	// Get the width in pixels.
+	int GetWidth() const { return m_nWidth; }
+
+	// Get the height in pixels.
+	int GetHeight() const { return m_nHeight; }
+
+	// Get the stride in pixels.
+	int GetStride() const { return m_nStride; }
+
+	// Get the first row of pixels.
+	uint32_t* GetBits() const { return m_pBits; }
+
+	// Get a pixel, zero if it is out of the canvas.
+	uint32_t GetPixel(int x, int y) const;
+
+	// Restrict painting to a rect within the canvas.
+	void SetClip(const Rect &rc);
+
+	// Get the rect painting is restricted to.
+	Rect GetClip() const { return m_rcClip; }
+
+	// Allow painting onto the whole canvas.
+	void ResetClip();
+
+	// Replace the pixels within the clip with a premultiplied color.
+	void Clear(uint32_t uColor = 0);
+
+	// Blend an ARGB color over a rect.
+	void FillRect(const Rect &rc, uint32_t dwColor);
+
+	// Blend an ARGB border of the width inside a rect, corners are blended once.
+	void DrawBorder(const Rect &rc, int nBorderWidth, uint32_t dwColor);
+
+	// Blend a premultiplied BGRA image over a rect, it is resampled if the sizes differ. Return false if the image is invalid.
+	bool DrawImage(const Rect &rc, const uint32_t *pSrc, int nSrcWidth, int nSrcHeight, int nSrcStride,
+		UICollectionViewImageScaler::Filter filter = UICollectionViewImageScaler::FilterBilinear);
+
+	// Count pixels differing from another canvas by more than the tolerance in any channel, -1 if the sizes differ.
+	int Compare(const UICollectionViewCanvas &canvas, int nTolerance = 0) const;
+
+	// Save the pixels as a top-down 32bpp BMP file.
+	bool SaveBitmap(const char *pszPath) const;
+
+	// Blend an ARGB color over 32bpp premultiplied BGRA pixels, the stride is in pixels.
+	static void FillPixels(uint32_t *pBits, int nWidth, int nHeight, int nStride, uint32_t dwColor);
+
+	// Blend premultiplied BGRA pixels over other ones, strides are in pixels.
+	static void BlendPixels(uint32_t *pDst, int nDstStride, const uint32_t *pSrc, int nSrcStride, int nWidth, int nHeight);
+
+private:
+
+	// Not copyable, the bits may be wrapped.
+	UICollectionViewCanvas(const UICollectionViewCanvas &);
+	UICollectionViewCanvas& operator=(const UICollectionViewCanvas &);
+
+	// Crop a rect with the clip, return false if nothing is left.
+	bool Crop(const Rect &rc, Rect &rcCropped) const;
+
+	// Get the first pixel of a row.
+	uint32_t* GetRow(int y) const { return m_pBits + (ptrdiff_t)y * m_nStride; }
+
+	int m_nWidth; // width in pixels.
+	int m_nHeight; // height in pixels.
+	int m_nStride; // distance between rows in pixels.
+	uint32_t *m_pBits; // first row.
+	Rect m_rcClip; // painting is restricted to this rect.
+	std::vector<uint32_t> m_Buffer; // owned pixels.
+};
+
+}
@@ -11,24 +11,64 @@
 #include "UICollectionViewItem.h"
 #include "UICollectionViewLasso.h"
 #include "UICollectionViewDelegate.h"
+#include "UICollectionViewSelection.h"
+#include "UICollectionViewSolidFill.h"
+#include <algorithm>
 
 namespace DuiLib
 {
 
+// Item invalidations are merged into at most this number of dirty rects per flush.
+static const size_t UICollectionViewMaxDirtyRects = 8;
+
+// Dirty rects added outside of a layout pass are flushed after this delay in milliseconds, i.e. once the
+// messages in the queue, which may add more of them, are processed.
+static const UINT UICollectionViewDirtyRectsDelay = 1;
+
+// Scrolling is considered settled after this delay in milliseconds.
+static const UINT UICollectionViewScrollSettleDelay = 150;
+
+// Idle jobs run on a timer of this interval in milliseconds while some are queued.
+static const UINT UICollectionViewIdleInterval = 30;
+
+// Idle time pre-warms the item pool for this number of rows.
+static const int UICollectionViewPrewarmRows = 2;
+
+// Default hysteresis in pixels items are kept outside of the viewport before being recycled.
+static const int UICollectionViewDefaultRecycleHysteresis = 32;
+
+// Default velocities in pixels per second to reduce the item quality.
+static const int UICollectionViewDefaultLowQualityVelocity = 3000;
+static const int UICollectionViewDefaultPlaceholderVelocity = 12000;
+
 // Constructor.
 UICollectionViewContentView::UICollectionViewContentView(UICollectionView *pOwner)
-	:m_pOwner(pOwner), m_nCount(0), m_nColumns(0), m_nRows(0), m_uMouseState(0),
-	 m_pDelegate(nullptr), m_pSelectionLasso(nullptr)
+	:m_pOwner(pOwner), m_nCount(0), m_uMouseState(0),
+	 m_pDelegate(nullptr), m_pSelectionLasso(nullptr), m_pThumbnailCache(nullptr),
+	 m_pThumbnailStore(nullptr), m_pTileCache(nullptr), m_pIdleScheduler(nullptr), m_bPrewarmQueued(false), m_fScrollVelocity(0), m_nLowQualityVelocity(UICollectionViewDefaultLowQualityVelocity),
+	 m_nPlaceholderVelocity(UICollectionViewDefaultPlaceholderVelocity), m_bScrolling(false), m_nScrollDirection(0), m_nRecycleHysteresis(UICollectionViewDefaultRecycleHysteresis), m_bScrollBlit(FALSE), m_bLayoutOnly(false),
+	 m_bInLayout(false), m_bDirtyClipValid(false), m_nDirtyRectsRaw(0), m_nDirtyRectsMerged(0), m_nReuseHits(0), m_nReuseMisses(0),
+	 m_bTileCache(FALSE), m_nVisibleFirst(0), m_nVisibleLast(-1), m_bImmediateMode(FALSE), m_nHotIndex(-1),
+	 m_nFocusIndex(-1), m_nSelectionAnchor(-1)
 {
 	ASSERT(m_pOwner);
 	memset(&m_szItem, 0, sizeof(SIZE));
 	memset(&m_szItemPadding, 0, sizeof(SIZE));
-	memset(&m_szContent, 0, sizeof(SIZE));
 	memset(&m_ptViewport, 0, sizeof(POINT));
 	memset(&m_rcScrollable, 0, sizeof(RECT));
+	memset(&m_liLastScroll, 0, sizeof(LARGE_INTEGER));
+	memset(&m_szTiledContent, 0, sizeof(SIZE));
+	memset(&m_rcDirtyClip, 0, sizeof(RECT));
+	m_Anchor.nIndex = -1;
+	m_Anchor.nOffset = 0;
 
 	m_ItemAttributes = UICollectionViewItemDefaultAttributes();
 	m_LassoAttributes = UICollectionViewLassoDefaultAttributes();
+
+	m_pThumbnailCache = new UICollectionViewThumbnailCache();
+	m_pThumbnailStore = new UICollectionViewThumbnailStore();
+	m_pTileCache = new UICollectionViewTileCache();
+	m_pIdleScheduler = new UICollectionViewIdleScheduler();
 }
 
 // Destructor.
@@ -39,6 +79,11 @@ UICollectionViewContentView::~UICollectionViewContentView()
 	}
 	m_Items.clear();
 
+	for (auto itr = m_AffineItems.begin(); itr != m_AffineItems.end(); itr ++) {
+		delete itr->second;
+	}
+	m_AffineItems.clear();
+
 	while (!m_ItemsPool.empty()) {
 		delete m_ItemsPool.top();
 		m_ItemsPool.pop();
@@ -47,6 +92,10 @@ UICollectionViewContentView::~UICollectionViewContentView()
 	m_SelectionIndexes.clear();
 	m_LassoPersistedSelectionIndexes.clear();
 	if (m_pSelectionLasso) delete m_pSelectionLasso;
+	if (m_pThumbnailCache) delete m_pThumbnailCache;
+	if (m_pThumbnailStore) delete m_pThumbnailStore;
+	if (m_pTileCache) delete m_pTileCache;
+	if (m_pIdleScheduler) delete m_pIdleScheduler;
 }
 
 // Get the delegate.
@@ -67,10 +116,39 @@ void UICollectionViewContentView::SetScrollPos(SIZE szPos)
 	if (!m_pVerticalScrollBar->IsVisible() || m_pVerticalScrollBar->GetScrollPos() == szPos.cy) {
 		return;
 	}
+
+	// track the scroll velocity, smoothed over the recent scroll events. the first event after
+	// scrolling settled has no reference, so the velocity starts from zero.
+	LARGE_INTEGER liNow, liFrequency;
+	::QueryPerformanceCounter(&liNow);
+	::QueryPerformanceFrequency(&liFrequency);
+	double fElapsed = (double)(liNow.QuadPart - m_liLastScroll.QuadPart) / liFrequency.QuadPart;
+	if (m_liLastScroll.QuadPart == 0 || fElapsed * 1000 >= UICollectionViewScrollSettleDelay) {
+		m_fScrollVelocity = 0;
+	} else if (fElapsed > 0) {
+		double fVelocity = abs(szPos.cy - m_pVerticalScrollBar->GetScrollPos()) / fElapsed;
+		double fWeight = min(1.0, fElapsed / 0.05);
+		m_fScrollVelocity += (fVelocity - m_fScrollVelocity) * fWeight;
+	}
+	m_liLastScroll = liNow;
+	m_bScrolling = true;
+	m_nScrollDirection = szPos.cy > m_pVerticalScrollBar->GetScrollPos() ? 1 : -1;
+
+	// restart the settle timer, items filled at a reduced quality are filled again once it fires.
+	if (m_pManager) {
+		m_pManager->KillTimer(this, TIMER_SCROLLSETTLE);
+		m_pManager->SetTimer(this, TIMER_SCROLLSETTLE, UICollectionViewScrollSettleDelay);
+	}
+
+	int nOldPos = m_pVerticalScrollBar->GetScrollPos();
 	m_pVerticalScrollBar->SetScrollPos(szPos.cy);
 
-	// update layout and also update visible items during scroll.
-	NeedUpdate();  
+	// update layout and also update visible items during scroll, with scroll blit only the exposed strip is repainted.
+	if (ScrollBlit(m_pVerticalScrollBar->GetScrollPos() - nOldPos)) {
+		NeedLayout();
+	} else {
+		NeedUpdate();
+	}
 }
 
 // Rewrite this method to render item controls inside `m_Items` map.
@@ -91,11 +169,8 @@ bool UICollectionViewContentView::DoPaint(HDC hDC, const RECT &rcPaint, CControl
 #endif // DEBUG
 
 	// render visible items onto screen.
-	for (auto itr = m_Items.begin(); itr != m_Items.end(); itr ++) {
-		if (!::IntersectRect(&rcTemp, &rcPaint, &itr->second->GetPos())) continue;
-		if (!::IntersectRect(&rcTemp, &m_rcScrollable, &rcTemp)) continue;
-		itr->second->Paint(hDC, rcTemp, nullptr);
-	}
+	if (m_bTileCache) PaintTiles(hDC, rcPaint);
+	else PaintItems(hDC, rcPaint);
 
 	// render scroll bar onto screen.
 	if (m_pVerticalScrollBar->IsVisible()) {
@@ -115,12 +190,245 @@ bool UICollectionViewContentView::DoPaint(HDC hDC, const RECT &rcPaint, CControl
 	return true;
 }
 
+// Paint items within the paint rect, return false if a part of it is not final, i.e. skeletons or reduced quality items.
+bool UICollectionViewContentView::PaintItems(HDC hDC, const RECT &rcPaint)
+{
+	// only visit cells intersecting the paint rect, so repainting a single item doesn't walk all visible items.
+	RECT rcRange = { 0 };
+	if (!GetItemRange(rcPaint, rcRange)) return true;
+
+	bool bFinal = true;
+	RECT rcTemp = { 0 };
+	for (int nRow = rcRange.top; nRow <= rcRange.bottom; nRow ++) {
+		for (int nColumn = rcRange.left; nColumn <= rcRange.right; nColumn ++) {
+			int nIndex = nRow * m_Layout.GetColumns() + nColumn;
+
+			// immediate mode paints visible cells directly.
+			if (m_bImmediateMode) {
+				if (nIndex < m_nVisibleFirst || nIndex > m_nVisibleLast) continue;
+				RECT rcCell = GetItemPos(nRow, nColumn);
+				if (!::IntersectRect(&rcTemp, &rcPaint, &rcCell)) continue;
+				if (!::IntersectRect(&rcTemp, &m_rcScrollable, &rcTemp)) continue;
+				PaintImmediateItem(hDC, nIndex, rcCell, rcTemp);
+				continue;
+			}
+
+			auto itr = m_Items.find(nIndex);
+			if (itr == m_Items.end()) {
+				// items waiting for their dwell time are painted as skeletons.
+				if (!m_BindQueue.IsPending(nIndex)) continue;
+				RECT rcCell = GetItemPos(nRow, nColumn);
+				if (!::IntersectRect(&rcTemp, &rcPaint, &rcCell)) continue;
+				if (!::IntersectRect(&rcTemp, &m_rcScrollable, &rcTemp)) continue;
+				PaintSkeletonItem(hDC, rcCell, rcTemp);
+				bFinal = false;
+				continue;
+			}
+			if (!::IntersectRect(&rcTemp, &rcPaint, &itr->second->GetPos())) continue;
+			if (!::IntersectRect(&rcTemp, &m_rcScrollable, &rcTemp)) continue;
+			itr->second->Paint(hDC, rcTemp, nullptr);
+			if (m_ReducedQualityIndexes.count(nIndex)) bFinal = false;
+		}
+	}
+	return bFinal;
+}
+
+// Paint the skeleton of an item which is not bound yet.
+void UICollectionViewContentView::PaintSkeletonItem(HDC hDC, const RECT &rcItem, const RECT &rcPaint)
+{
+	// a single flat fill with the round corners of item controls, nothing of the delegate is visited.
+	UICollectionViewSolidFill::FillRound(hDC, rcItem, rcPaint, 3, 3, GetAdjustColor(m_ItemAttributes.dwSkeletonColor));
+}
+
+// Paint an item without an item control in immediate mode.
+void UICollectionViewContentView::PaintImmediateItem(HDC hDC, int nIndex, const RECT &rcItem, const RECT &rcPaint)
+{
+	if (!m_pDelegate) return;
+
+	// same visual states as item controls.
+	UICollectionViewItemAttributes *pInfo = &m_ItemAttributes;
+	DWORD dwBkColor = pInfo->dwBkColor;
+	DWORD dwBdColor = pInfo->dwBdColor;
+	UINT uState = 0;
+	if (!IsEnabled()) {
+		dwBkColor = pInfo->dwDisabledBkColor;
+		dwBdColor = pInfo->dwDisabledBdColor;
+		uState = UISTATE_DISABLED;
+	} else if (m_SelectionIndexes.count(nIndex) != 0 && m_pDelegate->CollectionViewShouldDrawItemSelection(m_pOwner)) {
+		dwBkColor = pInfo->dwSelectedBkColor;
+		dwBdColor = pInfo->dwSelectedBdColor;
+		uState = UISTATE_SELECTED;
+	} else if (nIndex == m_nHotIndex && m_pDelegate->CollectionViewShouldDrawItemHover(m_pOwner)) {
+		dwBkColor = pInfo->dwHotBkColor;
+		dwBdColor = pInfo->dwHotBdColor;
+		uState = UISTATE_HOT;
+	}
+
+	// background, border and content in the order item controls paint them, with the same round corners.
+	// the background is filled before clipping, so it stays on the fast path of a rectangular clip.
+	UICollectionViewSolidFill::FillRound(hDC, rcItem, rcPaint, 3, 3, GetAdjustColor(dwBkColor));
+	CRenderClip clip;
+	CRenderClip::GenerateRoundClip(hDC, rcPaint, rcItem, 3, 3, clip);
+	if (pInfo->nBorderWidth > 0)
+		CRenderEngine::DrawRoundRect(hDC, rcItem, 3, 3, pInfo->nBorderWidth, GetAdjustColor(dwBdColor));
+	m_pDelegate->CollectionViewDrawItem(m_pOwner, hDC, rcItem, rcPaint, nIndex, uState);
+}
+
+// Get the index of the item at a point in window coordinates.
+int UICollectionViewContentView::GetItemIndexAtPoint(POINT pt) const
+{
+	RECT rcPoint = { pt.x, pt.y, pt.x + 1, pt.y + 1 };
+	RECT rcRange = { 0 };
+	if (!GetItemRange(rcPoint, rcRange)) return -1;
+
+	// the point may be on the padding between items.
+	int nIndex = rcRange.top * m_Layout.GetColumns() + rcRange.left;
+	RECT rcCell = GetItemPos(rcRange.top, rcRange.left);
+	if (nIndex >= m_nCount || !::PtInRect(&rcCell, pt)) return -1;
+	return nIndex;
+}
+
+// Track the item under the mouse in immediate mode.
+void UICollectionViewContentView::SetHotIndex(int nIndex)
+{
+	if (nIndex == m_nHotIndex) return;
+
+	int nOldIndex = m_nHotIndex;
+	m_nHotIndex = nIndex;
+	if (m_pDelegate && m_pDelegate->CollectionViewShouldDrawItemHover(m_pOwner)) {
+		InvalidateItemAtIndex(nOldIndex);
+		InvalidateItemAtIndex(nIndex);
+	}
+}
+
+// Repaint an item.
+void UICollectionViewContentView::InvalidateItemAtIndex(int nIndex)
+{
+	if (nIndex < 0 || nIndex >= m_nCount) return;
+
+	if (!m_bImmediateMode) {
+		auto itr = m_Items.find(nIndex);
+		if (itr != m_Items.end()) {
+			itr->second->Invalidate();
+			return;
+		}
+	}
+
+	// cached tiles of invisible items are invalidated too, they are drawn once the item is scrolled in.
+	if (m_Layout.GetColumns() <= 0) return;
+	RECT rcCell = GetItemPos(nIndex / m_Layout.GetColumns(), nIndex % m_Layout.GetColumns());
+	InvalidateTiles(rcCell);
+	if (nIndex >= m_nVisibleFirst && nIndex <= m_nVisibleLast) AddDirtyRect(rcCell);
+}
+
+// Calculate item position (zero based, row, column) in window coordinates.
+RECT UICollectionViewContentView::GetItemPos(int nRow, int nColumn) const
+{
+	UICollectionViewRect rcItem = m_Layout.GetItemRect(nRow, nColumn);
+	RECT rcCell = { rcItem.left, rcItem.top, rcItem.right, rcItem.bottom };
+	::OffsetRect(&rcCell, m_ptViewport.x, m_ptViewport.y);
+	return rcCell;
+}
+
+// Get the rows and columns of cells intersecting a rect in window coordinates.
+bool UICollectionViewContentView::GetItemRange(const RECT &rc, RECT &rcRange) const
+{
+	RECT rcTemp = { 0 };
+	if (!::IntersectRect(&rcTemp, &rc, &m_rcScrollable)) return false;
+
+	// the layout works in content coordinates, whose origin is the viewport.
+	::OffsetRect(&rcTemp, -m_ptViewport.x, -m_ptViewport.y);
+	UICollectionViewRect rcContent = { rcTemp.left, rcTemp.top, rcTemp.right, rcTemp.bottom };
+	UICollectionViewRect rcCells = { 0 };
+	if (!m_Layout.GetItemRange(rcContent, rcCells)) return false;
+
+	rcRange.left = rcCells.left;
+	rcRange.top = rcCells.top;
+	rcRange.right = rcCells.right;
+	rcRange.bottom = rcCells.bottom;
+	return true;
+}
+
+// Composite cached tiles, tiles missing from the cache are painted and cached if they are fully visible.
+void UICollectionViewContentView::PaintTiles(HDC hDC, const RECT &rcPaint)
+{
+	m_pTileCache->BeginFrame();
+
+	RECT rcVisible = { 0 };
+	if (!::IntersectRect(&rcVisible, &rcPaint, &m_rcScrollable)) return;
+
+	// pixels can only be read back from a memory DC, and only where they are painted in this frame,
+	// i.e. within a simple clip region (parents' client area).
+	RECT rcClip = { 0 };
+	bool bCapture = (::GetObjectType(hDC) == OBJ_MEMDC && ::GetClipBox(hDC, &rcClip) == SIMPLEREGION);
+	if (bCapture) ::IntersectRect(&rcClip, &rcClip, &rcVisible);
+
+	// tiles are keyed in content coordinates, whose origin is the viewport.
+	int nTileSize = m_pTileCache->GetTileSize();
+	int nColumnFirst = max(0, (int)(rcVisible.left - m_ptViewport.x)) / nTileSize;
+	int nColumnLast = max(0, (int)(rcVisible.right - 1 - m_ptViewport.x)) / nTileSize;
+	int nRowFirst = max(0, (int)(rcVisible.top - m_ptViewport.y)) / nTileSize;
+	int nRowLast = max(0, (int)(rcVisible.bottom - 1 - m_ptViewport.y)) / nTileSize;
+
+	RECT rcPart = { 0 };
+	RECT rcTemp = { 0 };
+	for (int nRow = nRowFirst; nRow <= nRowLast; nRow ++) {
+		for (int nColumn = nColumnFirst; nColumn <= nColumnLast; nColumn ++) {
+			RECT rcTile = { m_ptViewport.x + nColumn * nTileSize, m_ptViewport.y + nRow * nTileSize, 0, 0 };
+			rcTile.right = rcTile.left + nTileSize;
+			rcTile.bottom = rcTile.top + nTileSize;
+			if (!::IntersectRect(&rcPart, &rcTile, &rcVisible)) continue;
+			if (m_pTileCache->Draw(nColumn, nRow, hDC, rcTile, rcPart)) continue;
+
+			// paint the tile from items, cache it if all its pixels are painted and final. cached tiles stay valid until
+			// the data of an item changes, so they also serve items scrolled out and back in.
+			bool bFinal = PaintItems(hDC, rcPart);
+			if (bFinal && bCapture && ::IntersectRect(&rcTemp, &rcTile, &rcClip) && ::EqualRect(&rcTemp, &rcTile)) {
+				m_pTileCache->Rasterize(nColumn, nRow, hDC, rcTile);
+			}
+		}
+	}
+}
+
+// Invalidate cached tiles intersecting a rect in window coordinates.
+void UICollectionViewContentView::InvalidateTiles(const RECT &rc)
+{
+	RECT rcContent = rc;
+	::OffsetRect(&rcContent, -m_ptViewport.x, -m_ptViewport.y);
+	m_pTileCache->Invalidate(rcContent);
+}
+
+// Invalidate cached tiles of visible items at the indexes.
+void UICollectionViewContentView::InvalidateTiles(const std::set<int> &sIndexes)
+{
+	for (auto itr = m_Items.begin(); itr != m_Items.end(); itr ++) {
+		if (sIndexes.count(itr->first)) InvalidateTiles(itr->second->GetPos());
+	}
+}
+
+// Invalidate cached tiles of the item at an index, wherever it is laid out.
+void UICollectionViewContentView::InvalidateTiles(int nIndex)
+{
+	int nColumns = m_Layout.GetColumns();
+	if (nIndex < 0 || nIndex >= m_nCount || nColumns <= 0) return;
+	InvalidateTiles(GetItemPos(nIndex / nColumns, nIndex % nColumns));
+}
+
 // Override to dynamically create / destroy / update item controls.
 void UICollectionViewContentView::SetPos(RECT rc, bool bNeedInvalidate)
 {
+	// pixels were shifted on screen by a scroll blit or invalidated precisely, moving items must not invalidate them.
+	bool bLayoutOnly = m_bLayoutOnly && ::EqualRect(&rc, &m_rcItem);
+	m_bLayoutOnly = false;
+	if (bLayoutOnly) bNeedInvalidate = false;
+
 	// this is a window based axis
 	CControlUI::SetPos(rc, bNeedInvalidate);
 
+	// dirty rects added during layout are invalidated at the end of it, parents may have moved.
+	m_bInLayout = true;
+	m_bDirtyClipValid = false;
+
 	// apply inset
 	rc.left += m_rcInset.left;
 	rc.top += m_rcInset.top;
@@ -138,41 +446,50 @@ void UICollectionViewContentView::SetPos(RECT rc, bool bNeedInvalidate)
 		m_pVerticalScrollBar->SetScrollPos(0);
 		m_pVerticalScrollBar->SetScrollRange(0);
 		m_rcScrollable = rc; // allow drag selection on an empty view.
+		m_nVisibleFirst = 0;
+		m_nVisibleLast = -1;
+		m_Anchor.nIndex = -1;
+		m_bInLayout = false;
+		FlushDirtyRects();
 		return;
 	}
 
-	//////////////////////////////////////////////////////////////////////////
-	// calculate total rows and columns based on data source, support item paddings
-	m_nColumns = ((rc.right - rc.left + m_szItemPadding.cx) / (m_szItem.cx + m_szItemPadding.cx));
-	if (m_nColumns == 0) m_nColumns = 1;
-	m_nRows = (m_nCount % m_nColumns) ? (m_nCount / m_nColumns + 1) : (m_nCount / m_nColumns);
-
-	// calculate the scrollable content size
-	m_szContent.cx = (rc.right - rc.left);
-	m_szContent.cy = m_nRows * (m_szItem.cy + m_szItemPadding.cy) - m_szItemPadding.cy;
-	//////////////////////////////////////////////////////////////////////////
-
-	// re-calculate, if vertical scroll is required
-	if (m_szContent.cy > (rc.bottom - rc.top)) {
+	// without an anchor, the first visible item anchors the scroll position if rows change, e.g. on resizing or zooming.
+	int nOldColumns = m_Layout.GetColumns();
+	int nOldRowHeight = m_Layout.GetRowHeight();
+	UICollectionViewAnchor anchor = m_Anchor;
+	bool bRowsAnchor = false;
+	if (anchor.nIndex < 0) {
+		SetScrollAnchor();
+		anchor = m_Anchor;
+		bRowsAnchor = true;
+	}
+	m_Anchor.nIndex = -1;
+
+	// calculate total rows and columns based on data source, support item paddings.
+	UICollectionViewSize szItem = { m_szItem.cx, m_szItem.cy };
+	UICollectionViewSize szPadding = { m_szItemPadding.cx, m_szItemPadding.cy };
+	m_Layout.SetItemSize(szItem);
+	m_Layout.SetItemPadding(szPadding);
+	m_Layout.SetCount(m_nCount);
+
+	// the layout reserves the scroll bar width if vertical scroll is required.
+	bool bScroll = m_Layout.Update(rc.right - rc.left, rc.bottom - rc.top, m_pVerticalScrollBar->GetFixedWidth());
+	UICollectionViewSize szContent = m_Layout.GetContentSize();
+	if (bScroll) {
 		// correct the right edge
 		rc.right -= m_pVerticalScrollBar->GetFixedWidth();
 
-		//////////////////////////////////////////////////////////////////////////
-		// calculate total rows and columns based on data source, support item paddings
-		m_nColumns = ((rc.right - rc.left + m_szItemPadding.cx) / (m_szItem.cx + m_szItemPadding.cx));
-		if (m_nColumns == 0) m_nColumns = 1;
-		m_nRows = (m_nCount % m_nColumns) ? (m_nCount / m_nColumns + 1) : (m_nCount / m_nColumns);
-
-		// calculate the scrollable content size
-		m_szContent.cx = (rc.right - rc.left);
-		m_szContent.cy = m_nRows * (m_szItem.cy + m_szItemPadding.cy) - m_szItemPadding.cy;
-		//////////////////////////////////////////////////////////////////////////
-
 		// correct vertical scroll bar
 		RECT rcScrollBarPos = { rc.right, rc.top, rc.right + m_pVerticalScrollBar->GetFixedWidth(), rc.bottom };
 		m_pVerticalScrollBar->SetPos(rcScrollBarPos);
 		m_pVerticalScrollBar->SetVisible(true);
-		m_pVerticalScrollBar->SetScrollRange(m_szContent.cy - (rc.bottom - rc.top));
+		m_pVerticalScrollBar->SetScrollRange(szContent.cy - (rc.bottom - rc.top));
+
+		// keep the anchor item at its offset from the top of the viewport, e.g. items above it were removed.
+		if (bRowsAnchor && nOldColumns == m_Layout.GetColumns() && nOldRowHeight == m_Layout.GetRowHeight())
+			anchor.nIndex = -1;
+		if (anchor.nIndex >= 0) m_pVerticalScrollBar->SetScrollPos(m_Layout.GetAnchoredScrollPos(anchor));
 		if (m_pVerticalScrollBar->GetScrollPos() > m_pVerticalScrollBar->GetScrollRange()) {
 			m_pVerticalScrollBar->SetScrollPos(m_pVerticalScrollBar->GetScrollRange());
 		}
@@ -185,62 +502,32 @@ void UICollectionViewContentView::SetPos(RECT rc, bool bNeedInvalidate)
 		m_pVerticalScrollBar->SetScrollRange(0);
 	}
 
+	// cached tiles are painted for the content size, e.g. columns are spread differently in another width.
+	if (szContent.cx != m_szTiledContent.cx || szContent.cy != m_szTiledContent.cy) {
+		m_pTileCache->RemoveAll();
+		m_szTiledContent.cx = szContent.cx;
+		m_szTiledContent.cy = szContent.cy;
+	}
+
 	// save scrollable area rect.
 	m_rcScrollable = rc;
 
 	// calculate index range of visible items by dividing scroll pos with item height
-	int nIndexFirst = (m_pVerticalScrollBar->GetScrollPos() / (m_szItem.cy + m_szItemPadding.cy)) * m_nColumns;
-	if (nIndexFirst < 0) nIndexFirst = 0;
-	int nIndexLast = ((m_pVerticalScrollBar->GetScrollPos() + rc.bottom - rc.top) / (m_szItem.cy + m_szItemPadding.cy) + 1) * m_nColumns - 1;
-	if (nIndexLast > m_nCount - 1) nIndexLast = (m_nCount - 1);
+	int nIndexFirst = 0;
+	int nIndexLast = -1;
+	m_Layout.GetVisibleRange(m_pVerticalScrollBar->GetScrollPos(), rc.bottom - rc.top, nIndexFirst, nIndexLast);
 	ASSERT(nIndexLast >= 0 && nIndexFirst >= 0 && nIndexLast >= nIndexFirst);
+	int nColumns = m_Layout.GetColumns();
 
-	// put items averagely on the X axis, an extra padding fix is required.
-	int nPaddingFix = (m_szContent.cx - (m_nColumns * (m_szItem.cx + m_szItemPadding.cx) - m_szItemPadding.cx)) / \
-		((m_nColumns - 1) > 0 ? (m_nColumns - 1) : 2);
-
-	// lambda to calculate item position.
-	auto GetItemPos = [&](int nRow, int nColumn) {
-		// code `(m_nColumns > 1)` is used to special handle single column.
-		RECT rcCell = {
-			((m_nColumns > 1) ? (nColumn * (m_szItem.cx + m_szItemPadding.cx + nPaddingFix) + m_ptViewport.x) : (nPaddingFix + m_ptViewport.x)),
-			nRow * (m_szItem.cy + m_szItemPadding.cy) + m_ptViewport.y,
-			((m_nColumns > 1) ? (nColumn * (m_szItem.cx + m_szItemPadding.cx + nPaddingFix) + m_ptViewport.x) : (nPaddingFix + m_ptViewport.x)) + m_szItem.cx,
-			nRow * (m_szItem.cy + m_szItemPadding.cy) + m_ptViewport.y + m_szItem.cy
-		};
-
-		return rcCell;
-	};
+	// items appearing while scrolling fast are filled at a reduced quality.
+	UICollectionViewItemQuality quality = GetItemQuality();
 
 	// update selection indexes with lasso selection area.
 	if (m_pSelectionLasso && m_pSelectionLasso->IsVisible() && m_pDelegate->CollectionViewShouldDrawItemSelection(m_pOwner)) {
+		// the layout works in content coordinates, whose origin is the viewport.
 		RECT rcSel = m_pSelectionLasso->GetPos();
-		RECT rcIdx = {-1, -1, -1, -1};
-
-		// calculate selection index range in X axis.
-		for (int nColumn = 0; nColumn < m_nColumns; nColumn ++) {
-			RECT rcCell = GetItemPos(0, nColumn);
-
-			// nearest cell, its right border is larger than rcSel.left.
-			if (rcCell.right > rcSel.left && rcIdx.left < 0)
-				rcIdx.left = nColumn; /* first matched */
-
-			// nearest cell, its left border is smaller than rcSel.right.
-			if (rcCell.left < rcSel.right)
-				rcIdx.right = nColumn; /* last matched */
-		}
-
-		// calculate selection index range in Y axis.
-		if (rcSel.top - m_ptViewport.y > 0) {
-			rcIdx.top = (rcSel.top - m_ptViewport.y) / (m_szItem.cy + m_szItemPadding.cy);
-			if ((rcSel.top - m_ptViewport.y) % (m_szItem.cy + m_szItemPadding.cy) > m_szItem.cy)
-				rcIdx.top ++;
-		} else {
-			rcIdx.top = 0;
-		}
-		if (rcSel.bottom - m_ptViewport.y > 0) {
-			rcIdx.bottom = (rcSel.bottom - m_ptViewport.y) / (m_szItem.cy + m_szItemPadding.cy);
-		}
+		UICollectionViewRect rcLasso = { rcSel.left - m_ptViewport.x, rcSel.top - m_ptViewport.y, rcSel.right - m_ptViewport.x, rcSel.bottom - m_ptViewport.y };
+		UICollectionViewRect rcIdx = m_Layout.GetLassoRange(rcLasso);
 
 #ifdef DEBUG
 		//CDuiString csLog;
@@ -251,72 +538,121 @@ void UICollectionViewContentView::SetPos(RECT rc, bool bNeedInvalidate)
 		// save a copy of previous index set before making changes.
 		std::set<int> sTempIndexes = m_SelectionIndexes;
 
-		// CTRL is not pressed.
-		if (::GetKeyState(VK_CONTROL) >= 0) { 
-			m_SelectionIndexes.clear();
-			if (rcIdx.left >= 0 && rcIdx.right >= 0 && rcIdx.top >= 0 && rcIdx.bottom >= 0) {
-				for (int i = rcIdx.left; i <= rcIdx.right; i ++) {
-					for (int j = rcIdx.top; j <= rcIdx.bottom; j ++) {
-						int nIndex = (j * m_nColumns + i);
-						if (nIndex < m_nCount) { /* boundary validation */
-							m_SelectionIndexes.insert(nIndex);
-						}
-					}
-				}
-			}
-
 		// CTRL can be used to do reverse selection.
-		} else {
-			m_SelectionIndexes = m_LassoPersistedSelectionIndexes;
-			if (rcIdx.left >= 0 && rcIdx.right >= 0 && rcIdx.top >= 0 && rcIdx.bottom >= 0) {
-				for (int i = rcIdx.left; i <= rcIdx.right; i ++) {
-					for (int j = rcIdx.top; j <= rcIdx.bottom; j ++) {
-						int nIndex = (j * m_nColumns + i);
-						if (m_LassoPersistedSelectionIndexes.count(nIndex)) {
-							m_SelectionIndexes.erase(nIndex);
-						} else if (nIndex < m_nCount) { /* boundary validation */
-							m_SelectionIndexes.insert(nIndex);
-						}	
-					}
-				}
-			}
-		}
+		bool bToggle = ::GetKeyState(VK_CONTROL) < 0;
+		m_SelectionIndexes = UICollectionViewSelection::SelectRange(m_LassoPersistedSelectionIndexes, rcIdx, nColumns, m_nCount, bToggle);
 
 		// notify selection changes.
 		if (m_SelectionIndexes != sTempIndexes) {
 			m_pDelegate->CollectionViewSelectionDidChange(m_pOwner, sTempIndexes, m_SelectionIndexes);
+			InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
 		}
 	}
 
-	// recycle those invisible items.
+	// immediate mode has no item controls.
+	if (m_bImmediateMode) {
+		m_nVisibleFirst = nIndexFirst;
+		m_nVisibleLast = nIndexLast;
+		m_bInLayout = false;
+		FlushDirtyRects();
+		return;
+	}
+	m_nVisibleFirst = nIndexFirst;
+	m_nVisibleLast = nIndexLast;
+
+	// items just outside of the viewport are kept within a hysteresis band, so jitter around a row boundary doesn't recycle
+	// and display them over and over. the band behind the scroll direction, where items leave, is twice as wide.
+	int nKeepFirst = nIndexFirst;
+	int nKeepLast = nIndexLast;
+	if (m_nRecycleHysteresis > 0) {
+		int nBefore = m_nScrollDirection >= 0 ? m_nRecycleHysteresis : m_nRecycleHysteresis / 2;
+		int nAfter = m_nScrollDirection <= 0 ? m_nRecycleHysteresis : m_nRecycleHysteresis / 2;
+		m_Layout.GetVisibleRange(m_pVerticalScrollBar->GetScrollPos() - nBefore, rc.bottom - rc.top + nBefore + nAfter, nKeepFirst, nKeepLast);
+	}
+
+	// recycle those invisible items, they stay bound to their index until they are reused for another one.
 	for (auto itr = m_Items.begin(); itr != m_Items.end();) {
-		if (itr->first < nIndexFirst || itr->first > nIndexLast) {
-			m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, itr->second);
-			m_ItemsPool.push(itr->second);
+		if (itr->first < nKeepFirst || itr->first > nKeepLast) {
+			m_AffineItems[itr->first] = itr->second;
 			itr = m_Items.erase(itr);
 		} else {
+			// kept items follow the content, they may be invalidated by their position.
+			if (itr->first < nIndexFirst || itr->first > nIndexLast)
+				itr->second->SetPos(GetItemPos(itr->first / nColumns, itr->first % nColumns), false);
 			itr ++;
 		}
 	}
 
+	// forget pending items scrolled out before their dwell time.
+	DWORD dwNow = ::GetTickCount();
+	m_BindQueue.BeginPass(nIndexFirst, nIndexLast, dwNow, m_bScrolling);
+
+	// with a bind budget, items nearest to the center of the viewport are bound first.
+	std::vector<int> vIndexes;
+	for (int i = nIndexFirst; i <= nIndexLast; i ++) vIndexes.push_back(i);
+	if (m_BindQueue.GetBudget() > 0) {
+		POINT ptCenter = { (rc.left + rc.right) / 2, (rc.top + rc.bottom) / 2 };
+		auto Distance = [&](int nIndex) -> INT64 {
+			RECT rcCell = GetItemPos(nIndex / nColumns, nIndex % nColumns);
+			INT64 dx = (rcCell.left + rcCell.right) / 2 - ptCenter.x;
+			INT64 dy = (rcCell.top + rcCell.bottom) / 2 - ptCenter.y;
+			return dx * dx + dy * dy;
+		};
+		std::stable_sort(vIndexes.begin(), vIndexes.end(), [&](int a, int b) { return Distance(a) < Distance(b); });
+	}
+
 	// layout the visible items.
-	for (int i = nIndexFirst; i <= nIndexLast; i ++) {
+	LARGE_INTEGER liStart, liFrequency;
+	::QueryPerformanceCounter(&liStart);
+	::QueryPerformanceFrequency(&liFrequency);
+	for (int i : vIndexes) {
 		UICollectionViewItem *pItem = nullptr;
 
+		// an item scrolled out and back in before being reused is handed back as is, e.g. scrolling back and forth. versioned
+		// items are kept across reloads, they are filled again if the data at their index changed.
+		auto affine = m_AffineItems.find(i);
+		if (affine != m_AffineItems.end()) {
+			pItem = affine->second;
+			m_Items[i] = pItem;
+			m_AffineItems.erase(affine);
+			if (pItem->m_uVersion == 0 || IsItemUpToDate(pItem, i)) {
+				pItem->SetIndex(i);
+				m_nReuseHits ++;
+			} else {
+				m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, pItem);
+				FillItem(pItem, i, quality);
+				InvalidateTiles(GetItemPos(i / nColumns, i % nColumns)); // cached tiles have its former data.
+			}
+		}
+
+		// items appearing while scrolling stay skeletons for the dwell time, and those over the bind budget of
+		// this frame until the next one.
+		if (m_Items.count(i) <= 0) {
+			LARGE_INTEGER liNow;
+			::QueryPerformanceCounter(&liNow);
+			double fElapsed = (double)(liNow.QuadPart - liStart.QuadPart) * 1000 / liFrequency.QuadPart;
+			UICollectionViewBindQueue::Action action = m_BindQueue.Decide(i, fElapsed);
+			if (action == UICollectionViewBindQueue::ActionDefer || action == UICollectionViewBindQueue::ActionWait) continue;
+			if (action == UICollectionViewBindQueue::ActionBindPending)
+				AddDirtyRect(GetItemPos(i / nColumns, i % nColumns)); // the layout may not repaint it.
+		}
+
 		// make sure we are reusing the existed items in current pool.
 		if (m_Items.count(i) <= 0) {
 			if (!m_ItemsPool.empty()) { // use recycle pool.
 				pItem = m_ItemsPool.top();
 				m_ItemsPool.pop();
-			} else { // create a new item control using template.
+			} else { // reuse an item bound to another index.
+				pItem = TakeAffineItem(nIndexFirst, nIndexLast);
+			}
+			if (!pItem) { // create a new item control using template.
 				pItem = m_pDelegate->CollectionViewReusableItemTemplate(m_pOwner);
 				pItem->SetContentView(this);
 				m_pManager->InitControls(pItem, this);
 			}
 
 			// request latest data via delegate, and fill it into the item.
-			pItem->DoInit(); pItem->SetIndex(i);
-			m_pDelegate->CollectionViewWillDisplayItem(m_pOwner, pItem, i);
+			FillItem(pItem, i, quality);
 
 			m_Items[i] = pItem;
 		} else {
@@ -324,11 +660,25 @@ void UICollectionViewContentView::SetPos(RECT rc, bool bNeedInvalidate)
 		}
 
 		// calculate item pos (zero based, row, column)
-		pItem->SetPos(GetItemPos((i / m_nColumns), (i % m_nColumns)));
+		pItem->SetPos(GetItemPos((i / nColumns), (i % nColumns)), !bLayoutOnly);
 
 		// notify item layout updates.
 		m_pDelegate->CollectionViewDidUpdateItemLayout(m_pOwner, pItem, i);
 	}
+
+	// bind pending items once the oldest one has stayed for the dwell time, or in the next frame if it is over budget.
+	if (m_pManager) {
+		m_pManager->KillTimer(this, TIMER_ITEMDWELL);
+		int nDelay = m_BindQueue.GetNextDelay();
+		if (nDelay >= 0) m_pManager->SetTimer(this, TIMER_ITEMDWELL, nDelay);
+	}
+
+	// jobs posted before the view had a window start now.
+	ScheduleIdleJobs();
+
+	// invalidate items changed during layout, e.g. selected by the lasso.
+	m_bInLayout = false;
+	FlushDirtyRects();
 }
 
 // Override to forward events to UICollectionView.
@@ -336,6 +686,35 @@ void UICollectionViewContentView::DoEvent(TEventUI& event)
 {
 	// use timer to scroll drag selection.
 	if (event.Type == UIEVENT_TIMER) {
+		if (event.wParam == TIMER_SCROLLSETTLE) {
+			m_pManager->KillTimer(this, TIMER_SCROLLSETTLE);
+			m_fScrollVelocity = 0;
+			m_bScrolling = false;
+			RefillReducedQualityItems();
+			return;
+		}
+		if (event.wParam == TIMER_IDLE) {
+			if (!m_pIdleScheduler->Run()) m_pManager->KillTimer(this, TIMER_IDLE);
+			return;
+		}
+		if (event.wParam == TIMER_DIRTYRECTS) {
+			m_pManager->KillTimer(this, TIMER_DIRTYRECTS);
+			FlushDirtyRects();
+			return;
+		}
+		if (event.wParam == TIMER_ITEMDWELL) {
+			m_pManager->KillTimer(this, TIMER_ITEMDWELL);
+
+			// DuiLib only lays out within WM_PAINT, the skeletons are repainted so a layout pass binds them.
+			int nColumns = m_Layout.GetColumns();
+			const std::map<int, uint32_t> &pending = m_BindQueue.GetPending();
+			for (auto itr = pending.begin(); itr != pending.end() && nColumns > 0; itr ++) {
+				AddDirtyRect(GetItemPos(itr->first / nColumns, itr->first % nColumns));
+			}
+			NeedLayout();
+			FlushDirtyRects();
+			return;
+		}
 		if (event.wParam == TIMER_SCROLLDN) { LineDown(); }
 		else if (event.wParam == TIMER_SCROLLUP) { LineUp(); }
 		m_pSelectionLasso->SetMouseMovePos(m_pSelectionLasso->GetMouseMovePos());
@@ -353,8 +732,12 @@ void UICollectionViewContentView::DoEvent(TEventUI& event)
 	if (event.Type == UIEVENT_BUTTONDOWN) {
 		if (::PtInRect(&m_rcScrollable, event.ptMouse) && (!m_pDelegate || m_pDelegate->CollectionViewShouldDrawItemSelection(m_pOwner))) {
 			m_uMouseState |= UISTATE_CAPTURED;
-			if (::GetKeyState(VK_CONTROL) >= 0)
-				m_SelectionIndexes.clear();
+			if (::GetKeyState(VK_CONTROL) >= 0) {
+				std::set<int> sTempIndexes;
+				sTempIndexes.swap(m_SelectionIndexes);
+				InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
+			}
+			m_nFocusIndex = m_nSelectionAnchor = GetItemIndexAtPoint(event.ptMouse);
 			m_pSelectionLasso->SetMouseDownPos(event.ptMouse); // start selection.
 			m_pSelectionLasso->SetVisible(true);
 			m_LassoPersistedSelectionIndexes = m_SelectionIndexes;
@@ -363,7 +746,8 @@ void UICollectionViewContentView::DoEvent(TEventUI& event)
 	} else if (event.Type == UIEVENT_BUTTONUP) {
 		if ((m_uMouseState & UISTATE_CAPTURED) != 0)
 			m_uMouseState &= ~UISTATE_CAPTURED;
-		m_pManager->KillTimer(this);
+		m_pManager->KillTimer(this, TIMER_SCROLLUP);
+		m_pManager->KillTimer(this, TIMER_SCROLLDN);
 		m_pSelectionLasso->SetVisible(false); // end selection.
 		m_LassoPersistedSelectionIndexes.clear();
 
@@ -374,19 +758,32 @@ void UICollectionViewContentView::DoEvent(TEventUI& event)
 				m_pManager->SetTimer(this, TIMER_SCROLLDN, 30);
 			else if (event.ptMouse.y < m_rcScrollable.top)
 				m_pManager->SetTimer(this, TIMER_SCROLLUP, 30);
-			else
-				m_pManager->KillTimer(this);
+			else {
+				m_pManager->KillTimer(this, TIMER_SCROLLUP);
+				m_pManager->KillTimer(this, TIMER_SCROLLDN);
+			}
 			POINT ptMouse = event.ptMouse;
 			ptMouse.x = max(ptMouse.x, m_rcScrollable.left);
 			ptMouse.x = min(ptMouse.x, m_rcScrollable.right);
 			//ptMouse.y = max(ptMouse.y, m_rcScrollable.top);
 			//ptMouse.y = min(ptMouse.y, m_rcScrollable.bottom);
 			m_pSelectionLasso->SetMouseMovePos(ptMouse);
+		} else if (m_bImmediateMode && IsEnabled()) {
+			SetHotIndex(GetItemIndexAtPoint(event.ptMouse));
 		}
 
+	} else if (event.Type == UIEVENT_MOUSELEAVE && m_bImmediateMode) {
+		SetHotIndex(-1);
+
+	} else if (event.Type == UIEVENT_DBLCLICK && m_bImmediateMode && IsEnabled()) {
+		int nIndex = GetItemIndexAtPoint(event.ptMouse);
+		if (nIndex >= 0 && m_pDelegate) m_pDelegate->CollectionViewDidDoubleClickItem(m_pOwner, nullptr, nIndex);
+
 	} else if (event.Type == UIEVENT_KEYDOWN) {
 		if (::GetKeyState(VK_CONTROL) < 0 && event.chKey == 'A') {
 			SelectAll(); // CTRL+A
+		} else if (!MoveFocusByKey(event.chKey)) {
+			CContainerUI::DoEvent(event);
 		}
 
 	} else {
@@ -394,6 +791,64 @@ void UICollectionViewContentView::DoEvent(TEventUI& event)
 	}
 }
 
+// Move the focused item and the selection by keyboard.
+bool UICollectionViewContentView::MoveFocusByKey(TCHAR chKey)
+{
+	if (!m_pDelegate || !m_pDelegate->CollectionViewShouldDrawItemSelection(m_pOwner) || !IsEnabled()) return false;
+
+	// save a copy of previous index set before making changes.
+	std::set<int> sTempIndexes = m_SelectionIndexes;
+
+	// CTRL+SPACE toggles the focused item.
+	if (chKey == VK_SPACE) {
+		if (::GetKeyState(VK_CONTROL) >= 0 || m_nFocusIndex < 0) return false;
+		if (!m_SelectionIndexes.erase(m_nFocusIndex)) m_SelectionIndexes.insert(m_nFocusIndex);
+		m_nSelectionAnchor = m_nFocusIndex;
+		m_pDelegate->CollectionViewSelectionDidChange(m_pOwner, sTempIndexes, m_SelectionIndexes);
+		InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
+		return true;
+	}
+
+	UICollectionViewMove move;
+	switch (chKey) {
+	case VK_LEFT: move = UICollectionViewMoveLeft; break;
+	case VK_RIGHT: move = UICollectionViewMoveRight; break;
+	case VK_UP: move = UICollectionViewMoveUp; break;
+	case VK_DOWN: move = UICollectionViewMoveDown; break;
+	case VK_PRIOR: move = UICollectionViewMovePageUp; break;
+	case VK_NEXT: move = UICollectionViewMovePageDown; break;
+	case VK_HOME: move = UICollectionViewMoveHome; break;
+	case VK_END: move = UICollectionViewMoveEnd; break;
+	default: return false;
+	}
+
+	int nViewHeight = m_rcScrollable.bottom - m_rcScrollable.top;
+	int nIndex = m_Layout.GetMovedIndex(m_nFocusIndex, move, nViewHeight);
+	if (nIndex < 0) return false;
+	if (::GetKeyState(VK_SHIFT) < 0) {
+		if (m_nSelectionAnchor < 0) m_nSelectionAnchor = m_nFocusIndex >= 0 ? m_nFocusIndex : nIndex;
+		m_SelectionIndexes = UICollectionViewSelection::SelectSpan(m_nSelectionAnchor, nIndex);
+	} else if (::GetKeyState(VK_CONTROL) >= 0) {
+		m_SelectionIndexes = UICollectionViewSelection::SelectSpan(nIndex, nIndex);
+		m_nSelectionAnchor = nIndex;
+	}
+	m_nFocusIndex = nIndex;
+
+	// scroll the focused item into view.
+	int nScrollPos = m_Layout.GetScrollPosToShow(nIndex, m_pVerticalScrollBar->GetScrollPos(), nViewHeight);
+	if (nScrollPos != m_pVerticalScrollBar->GetScrollPos()) {
+		SIZE szPos = { 0, nScrollPos };
+		SetScrollPos(szPos);
+	}
+
+	// notify selection changes.
+	if (m_SelectionIndexes != sTempIndexes) {
+		m_pDelegate->CollectionViewSelectionDidChange(m_pOwner, sTempIndexes, m_SelectionIndexes);
+		InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
+	}
+	return true;
+}
+
 // Select all items.
 void UICollectionViewContentView::SelectAll()
 {
@@ -404,16 +859,14 @@ void UICollectionViewContentView::SelectAll()
 	// save a copy of previous index set before making changes.
 	std::set<int> sTempIndexes = m_SelectionIndexes;
 
-	m_SelectionIndexes.clear();
-	for (int i = 0; i < m_nCount; i ++)
-		m_SelectionIndexes.insert(i);
+	m_SelectionIndexes = UICollectionViewSelection::SelectAll(m_nCount);
 
 	// notify selection changes.
 	if (m_pDelegate && m_SelectionIndexes != sTempIndexes) {
 		m_pDelegate->CollectionViewSelectionDidChange(m_pOwner, sTempIndexes, m_SelectionIndexes);
 	}
 
-	Invalidate();
+	InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
 }
 
 // Deselect all items.
@@ -433,7 +886,7 @@ void UICollectionViewContentView::DeselectAll()
 		m_pDelegate->CollectionViewSelectionDidChange(m_pOwner, sTempIndexes, m_SelectionIndexes);
 	}
 
-	Invalidate();
+	InvalidateSelectionChanges(sTempIndexes, m_SelectionIndexes);
 }
 
 // Parse XML to configure the UI appearance.
@@ -458,6 +911,10 @@ void UICollectionViewContentView::SetAttribute(LPCTSTR pstrName, LPCTSTR pstrVal
 		m_pSelectionLasso->SetManager(m_pManager, this, false);
 	}
 
+	// attributes may change the layout, a pending partial repaint no longer covers it, nor do cached tiles.
+	m_bLayoutOnly = false;
+	m_pTileCache->RemoveAll();
+
 	if (_tcscmp(pstrName, _T("inset")) == 0) {
 		LPTSTR pstr = NULL;
 		m_rcInset.left = _tcstol(pstrValue, &pstr, 10);  ASSERT(pstr);    
@@ -531,6 +988,41 @@ void UICollectionViewContentView::SetAttribute(LPCTSTR pstrName, LPCTSTR pstrVal
 	} else if (_tcscmp(pstrName, _T("lassobordersize")) == 0) {
 		m_LassoAttributes.nLassoBorderWidth = (_ttoi(pstrValue));
 		Invalidate();
+	} else if (_tcscmp(pstrName, _T("thumbnailcachesize")) == 0) {
+		int nMegabytes = _ttoi(pstrValue);
+		if (nMegabytes < 0) nMegabytes = 0;
+		m_pThumbnailCache->SetBudget((SIZE_T)nMegabytes * 1024 * 1024);
+	} else if (_tcscmp(pstrName, _T("thumbnailatlas")) == 0) {
+		m_pThumbnailCache->SetPackingEnabled(_tcscmp(pstrValue, _T("true")) == 0);
+	} else if (_tcscmp(pstrName, _T("tilecache")) == 0) {
+		m_bTileCache = (_tcscmp(pstrValue, _T("true")) == 0);
+	} else if (_tcscmp(pstrName, _T("tilecachesize")) == 0) {
+		int nMegabytes = _ttoi(pstrValue);
+		if (nMegabytes < 0) nMegabytes = 0;
+		m_pTileCache->SetBudget((SIZE_T)nMegabytes * 1024 * 1024);
+	} else if (_tcscmp(pstrName, _T("scrollblit")) == 0) {
+		m_bScrollBlit = (_tcscmp(pstrValue, _T("true")) == 0);
+	} else if (_tcscmp(pstrName, _T("itemqualityvelocity")) == 0) {
+		LPTSTR pstr = NULL;
+		m_nLowQualityVelocity = _tcstol(pstrValue, &pstr, 10);  ASSERT(pstr);
+		m_nPlaceholderVelocity = _tcstol(pstr + 1, &pstr, 10);  ASSERT(pstr);
+	} else if (_tcscmp(pstrName, _T("itemdwelltime")) == 0) {
+		int nDwellTime = _ttoi(pstrValue);
+		m_BindQueue.SetDwellTime(nDwellTime > 0 ? nDwellTime : 0);
+	} else if (_tcscmp(pstrName, _T("recyclehysteresis")) == 0) {
+		int nHysteresis = _ttoi(pstrValue);
+		m_nRecycleHysteresis = nHysteresis > 0 ? nHysteresis : 0;
+	} else if (_tcscmp(pstrName, _T("idleslicetime")) == 0) {
+		int nSliceTime = _ttoi(pstrValue);
+		m_pIdleScheduler->SetSliceTime(nSliceTime > 0 ? nSliceTime : 1);
+	} else if (_tcscmp(pstrName, _T("itembindbudget")) == 0) {
+		int nBudget = _ttoi(pstrValue);
+		m_BindQueue.SetBudget(nBudget > 0 ? nBudget : 0);
+	} else if (_tcscmp(pstrName, _T("itemskeletoncolor")) == 0) {
+		LPTSTR pstr = NULL;
+		if (*pstrValue == _T('#')) pstrValue = ::CharNext(pstrValue);
+		m_ItemAttributes.dwSkeletonColor = _tcstoul(pstrValue, &pstr, 16);
+		Invalidate();
 	}
 
 	CControlUI::SetAttribute(pstrName, pstrValue);
@@ -550,16 +1042,12 @@ bool UICollectionViewContentView::RemoveAt(std::set<int> sIndexes, BOOL bKeepSel
 	// notify delegate to update data source.
 	if (m_pDelegate) m_pDelegate->CollectionViewWillRemoveItemsAtIndexes(m_pOwner, sTempIndexes);
 
-	// lambda to decrease indexes in selection index set.
-	auto UpdateIndexset = [](std::set<int> &sIndexes, int nBound) {
-		// find all indexes greater than the bound and decrease them by 1.
-		std::set<int> sNewIndexes;
-		for (auto itr = sIndexes.begin(); itr != sIndexes.lower_bound(nBound); itr ++)
-			sNewIndexes.insert(*itr);
-		for (auto itr = sIndexes.upper_bound(nBound); itr != sIndexes.end(); itr ++)
-			sNewIndexes.insert(*itr - 1);
-		sIndexes = sNewIndexes;
-	};
+	// items bound to shifted indexes can't be handed back.
+	RecycleAffineItems();
+
+	// anchor the first visible item, it is shifted by the removed items above it, or replaced by the next one if removed.
+	SetScrollAnchor();
+	if (m_Anchor.nIndex >= 0) m_Anchor.nIndex = UICollectionViewSelection::GetIndexAfterRemoval(m_Anchor.nIndex, sTempIndexes);
 
 	// lambda to decrease indexes in item map keys.
 	auto UpdateItemsMap = [&](int nBound) {
@@ -589,16 +1077,21 @@ bool UICollectionViewContentView::RemoveAt(std::set<int> sIndexes, BOOL bKeepSel
 	// indexes after items deletion.
 	for (auto itr = sTempIndexes.rbegin(); itr != sTempIndexes.rend(); itr ++) {
 		if (bKeepSelections) {
-			UpdateIndexset(m_SelectionIndexes, *itr);
-			UpdateIndexset(m_LassoPersistedSelectionIndexes, *itr);
+			UICollectionViewSelection::RemoveIndex(m_SelectionIndexes, *itr);
+			UICollectionViewSelection::RemoveIndex(m_LassoPersistedSelectionIndexes, *itr);
 		}
+		UICollectionViewSelection::RemoveIndex(m_ReducedQualityIndexes, *itr);
 		UpdateItemsMap(*itr);
 	}
 
 	// reduce total count.
 	m_nCount -= sTempIndexes.size();
 	if (m_nCount < 0) m_nCount = 0;
+	m_nHotIndex = m_nFocusIndex = m_nSelectionAnchor = -1;
+	m_BindQueue.Clear();
 
+	m_bLayoutOnly = false;
+	m_pTileCache->RemoveAll();
 	NeedUpdate();
 
 	// notify delegate at the end of removal.
@@ -607,6 +1100,52 @@ bool UICollectionViewContentView::RemoveAt(std::set<int> sIndexes, BOOL bKeepSel
 	return true;
 }
 
+// Insert items at the indexes, numbered after the insertion.
+bool UICollectionViewContentView::InsertAt(std::set<int> sIndexes)
+{
+	// an index may be at most the count after the insertions before it.
+	std::set<int> sTempIndexes;
+	for (int i : sIndexes) {
+		if (i >= 0 && i <= m_nCount + (int)sTempIndexes.size()) {
+			sTempIndexes.insert(i);
+		}
+	}
+	if (sTempIndexes.empty()) return false;
+
+	// items bound to shifted indexes can't be handed back.
+	RecycleAffineItems();
+
+	// anchor the first visible item, it is shifted by the items inserted above it, so it stays in place on screen.
+	SetScrollAnchor();
+	if (m_Anchor.nIndex >= 0) m_Anchor.nIndex = UICollectionViewSelection::GetIndexAfterInsertion(m_Anchor.nIndex, sTempIndexes);
+
+	// visible items keep their data, they are bound to the shifted indexes.
+	std::map<int, UICollectionViewItem *> mNewMap;
+	for (auto itr : m_Items) {
+		int nIndex = UICollectionViewSelection::GetIndexAfterInsertion(itr.first, sTempIndexes);
+		mNewMap[nIndex] = itr.second;
+		if (itr.second) itr.second->SetIndex(nIndex);
+	}
+	m_Items = mNewMap;
+
+	// selections follow their items.
+	for (int i : sTempIndexes) {
+		UICollectionViewSelection::InsertIndex(m_SelectionIndexes, i);
+		UICollectionViewSelection::InsertIndex(m_LassoPersistedSelectionIndexes, i);
+		UICollectionViewSelection::InsertIndex(m_ReducedQualityIndexes, i);
+	}
+
+	// increase total count.
+	m_nCount += sTempIndexes.size();
+	m_nHotIndex = m_nFocusIndex = m_nSelectionAnchor = -1;
+	m_BindQueue.Clear();
+
+	m_bLayoutOnly = false;
+	m_pTileCache->RemoveAll();
+	NeedUpdate();
+	return true;
+}
+
 // Remove all items.
 void UICollectionViewContentView::RemoveAll()
 {
@@ -625,6 +1164,7 @@ void UICollectionViewContentView::RemoveAll()
 	// setting count to zero.
 	m_nCount = 0;
 
+	m_bLayoutOnly = false;
 	NeedUpdate();
 
 	// notify delegate at the end of removal.
@@ -632,17 +1172,20 @@ void UICollectionViewContentView::RemoveAll()
 }
 
 // By default refresh internal cache and rebuild the whole view.
-void UICollectionViewContentView::ReloadData(BOOL bFullReload)
+void UICollectionViewContentView::ReloadData(BOOL bFullReload, BOOL bKeepState)
 {
-	if (bFullReload) {
+	if (bFullReload && !bKeepState) {
 
-		// empty cached items.
-		ClearVisibleItems();
+		// empty cached items, versioned ones are handed back to their index if its data version is unchanged.
+		ClearVisibleItems(true);
 
 		// reset vertical scroll bar.
 		m_pVerticalScrollBar->SetVisible(false);
 		m_pVerticalScrollBar->SetScrollPos(0);
 		m_pVerticalScrollBar->SetScrollRange(0);
+		m_nVisibleFirst = 0;
+		m_nVisibleLast = -1;
+		m_Anchor.nIndex = -1;
 	}
 
 	if (!m_pOwner || !m_pDelegate) {
@@ -661,23 +1204,425 @@ void UICollectionViewContentView::ReloadData(BOOL bFullReload)
 		m_szItemPadding = szPadding;
 	}
 
+	// the first visible item stays in place if the state is kept, it is anchored before the count changes.
+	if (bFullReload && bKeepState) SetScrollAnchor();
+
 	// we only update file count when reload is explicitly called. 
 	m_nCount = m_pDelegate->CollectionViewItemsCount(m_pOwner);
 
+	// keep the user's context, the scroll pos is clamped by the next layout.
+	if (bFullReload && bKeepState) {
+		// items beyond the new count are recycled, the others are filled again.
+		std::set<int> sIndexes;
+		for (auto itr = m_Items.begin(); itr != m_Items.end();) {
+			if (itr->first >= m_nCount) {
+				m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, itr->second);
+				m_ItemsPool.push(itr->second);
+				itr = m_Items.erase(itr);
+			} else {
+				sIndexes.insert(itr->first);
+				itr ++;
+			}
+		}
+		RecycleAffineItems(true);
+
+		// drop selections and bookkeeping of indexes which no longer exist.
+		m_SelectionIndexes.erase(m_SelectionIndexes.lower_bound(m_nCount), m_SelectionIndexes.end());
+		m_LassoPersistedSelectionIndexes.erase(m_LassoPersistedSelectionIndexes.lower_bound(m_nCount), m_LassoPersistedSelectionIndexes.end());
+		m_ReducedQualityIndexes.erase(m_ReducedQualityIndexes.lower_bound(m_nCount), m_ReducedQualityIndexes.end());
+		m_BindQueue.RemoveFrom(m_nCount);
+
+		ReloadItemsAtIndexes(sIndexes);
+	}
+
+	// immediate mode draws items with the delegate, item controls are recycled.
+	BOOL bImmediateMode = m_pDelegate->CollectionViewShouldDrawItemsImmediately(m_pOwner);
+	if (bImmediateMode && (!m_Items.empty() || !m_AffineItems.empty())) ClearVisibleItems();
+	m_bImmediateMode = bImmediateMode;
+	m_nHotIndex = m_nFocusIndex = m_nSelectionAnchor = -1;
+
+	// item controls for scrolling are created in idle time, a queued job picks up the new column count itself.
+	if (!m_bImmediateMode && !m_bPrewarmQueued) {
+		m_bPrewarmQueued = true;
+		PostIdleJob([this](UICollectionViewIdleScheduler *pScheduler) { return PrewarmItemsPool(pScheduler); });
+	}
+
+	m_bLayoutOnly = false;
+	m_pTileCache->RemoveAll();
 	NeedUpdate();
 }
 
-// Clear all visible item controls.
-void UICollectionViewContentView::ClearVisibleItems()
+// Anchor the scroll position at the first visible item.
+void UICollectionViewContentView::SetScrollAnchor()
+{
+	m_Anchor.nIndex = -1;
+	if (m_nVisibleFirst > m_nVisibleLast || m_Layout.GetColumns() <= 0 || !m_pVerticalScrollBar->IsVisible()) return;
+	m_Anchor = m_Layout.GetAnchor(m_pVerticalScrollBar->GetScrollPos(), m_rcScrollable.bottom - m_rcScrollable.top);
+}
+
+// Fill items at the indexes again via delegate.
+void UICollectionViewContentView::ReloadItemsAtIndexes(const std::set<int> &sIndexes)
+{
+	if (!m_pDelegate) return;
+
+	UICollectionViewItemQuality quality = GetItemQuality();
+	for (int i : sIndexes) {
+		if (i < 0 || i >= m_nCount) continue;
+
+		// immediate mode has no items to fill, the delegate paints the latest data.
+		if (m_bImmediateMode) {
+			InvalidateItemAtIndex(i);
+			continue;
+		}
+
+		// scrolled out items bound to the index are stale, they are filled again once scrolled in. versioned ones are checked
+		// by then.
+		auto affine = m_AffineItems.find(i);
+		if (affine != m_AffineItems.end() && affine->second->m_uVersion == 0) {
+			m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, affine->second);
+			m_ItemsPool.push(affine->second);
+			m_ReducedQualityIndexes.erase(i);
+			m_AffineItems.erase(affine);
+			continue;
+		}
+
+		// bind visible items to the index again, keeping their mouse state. items without one are filled once bound.
+		auto itr = m_Items.find(i);
+		if (itr == m_Items.end() || IsItemUpToDate(itr->second, i)) continue;
+		UICollectionViewItem *pItem = itr->second;
+		UINT uMouseState = pItem->m_uMouseState;
+		m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, pItem);
+		FillItem(pItem, i, quality);
+		pItem->m_uMouseState = uMouseState;
+		pItem->Invalidate();
+	}
+}
+
+// Take a recycled item still bound to an index out of the visible range.
+UICollectionViewItem* UICollectionViewContentView::TakeAffineItem(int nIndexFirst, int nIndexLast)
+{
+	if (m_AffineItems.empty()) return nullptr;
+
+	// the item farthest from the visible range is the least likely to be scrolled in again, items within it are about
+	// to be handed back.
+	auto first = m_AffineItems.begin();
+	auto last = --m_AffineItems.end();
+	bool bFirst = first->first < nIndexFirst;
+	bool bLast = last->first > nIndexLast;
+	if (!bFirst && !bLast) return nullptr;
+	auto itr = (bFirst && (!bLast || nIndexFirst - first->first >= last->first - nIndexLast)) ? first : last;
+
+	// recycling was deferred until the item is reused.
+	UICollectionViewItem *pItem = itr->second;
+	if (m_pDelegate) m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, pItem);
+	m_ReducedQualityIndexes.erase(itr->first);
+	m_AffineItems.erase(itr);
+	return pItem;
+}
+
+// Recycle items still bound to their index.
+void UICollectionViewContentView::RecycleAffineItems(bool bKeepVersioned)
+{
+	for (auto itr = m_AffineItems.begin(); itr != m_AffineItems.end();) {
+		if (bKeepVersioned && itr->second->m_uVersion != 0 && m_ReducedQualityIndexes.count(itr->first) == 0) {
+			itr ++;
+			continue;
+		}
+		if (m_pDelegate) m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, itr->second);
+		m_ItemsPool.push(itr->second);
+		m_ReducedQualityIndexes.erase(itr->first);
+		itr = m_AffineItems.erase(itr);
+	}
+}
+
+// Fill an item with the data at an index via delegate.
+void UICollectionViewContentView::FillItem(UICollectionViewItem *pItem, int nIndex, UICollectionViewItemQuality quality)
+{
+	// the version is read before filling, data changing meanwhile is filled again next time.
+	UINT64 uVersion = m_pDelegate->CollectionViewVersionForItemAtIndex(m_pOwner, nIndex);
+	pItem->DoInit(); pItem->SetIndex(nIndex);
+	m_ReducedQualityIndexes.erase(nIndex);
+	if (m_pDelegate->CollectionViewWillDisplayItemWithQuality(m_pOwner, pItem, nIndex, quality) < UICollectionViewItemQualityFull)
+		m_ReducedQualityIndexes.insert(nIndex);
+	pItem->m_uVersion = uVersion;
+	m_nReuseMisses ++;
+}
+
+// Return true if an item was filled with the current version of the data at its index.
+bool UICollectionViewContentView::IsItemUpToDate(UICollectionViewItem *pItem, int nIndex) const
+{
+	return pItem->m_uVersion != 0 && pItem->m_uVersion == m_pDelegate->CollectionViewVersionForItemAtIndex(m_pOwner, nIndex);
+}
+
+// Get counters of reused items.
+UICollectionViewReuseStats UICollectionViewContentView::GetReuseStats() const
+{
+	UICollectionViewReuseStats stats = { m_nReuseHits, m_nReuseMisses };
+	return stats;
+}
+
+// Reset counters of reused items.
+void UICollectionViewContentView::ResetReuseStats()
+{
+	m_nReuseHits = 0;
+	m_nReuseMisses = 0;
+}
+
+// Queue a low priority job.
+void UICollectionViewContentView::PostIdleJob(const UICollectionViewIdleScheduler::Job &job)
+{
+	m_pIdleScheduler->Post(job);
+	ScheduleIdleJobs();
+}
+
+// Start the idle timer if jobs are queued.
+void UICollectionViewContentView::ScheduleIdleJobs()
+{
+	// timer messages are only generated when the message queue is empty, the timer is not restarted if it is running.
+	if (m_pManager && !m_pIdleScheduler->IsEmpty())
+		m_pManager->SetTimer(this, TIMER_IDLE, UICollectionViewIdleInterval);
+}
+
+// Create item controls into the pool in idle time.
+bool UICollectionViewContentView::PrewarmItemsPool(UICollectionViewIdleScheduler *pScheduler)
+{
+	m_bPrewarmQueued = PrewarmItems(pScheduler);
+	return m_bPrewarmQueued;
+}
+
+// Create item controls into the pool until the scheduler yields, return true if more are needed.
+bool UICollectionViewContentView::PrewarmItems(UICollectionViewIdleScheduler *pScheduler)
 {
-	// recycle all visible item controls.
+	if (!m_pManager || !m_pDelegate || m_bImmediateMode) return false;
+
+	// a scrolled-in row usually reuses the items of a scrolled-out one, a couple of rows cover faster scrolling.
+	size_t nTarget = (size_t)m_Layout.GetColumns() * UICollectionViewPrewarmRows;
+	while (m_ItemsPool.size() < nTarget) {
+		UICollectionViewItem *pItem = m_pDelegate->CollectionViewReusableItemTemplate(m_pOwner);
+		pItem->SetContentView(this);
+		m_pManager->InitControls(pItem, this);
+		m_ItemsPool.push(pItem);
+		if (pScheduler->ShouldYield()) return m_ItemsPool.size() < nTarget;
+	}
+	return false;
+}
+
+// Clear all visible item controls, versioned ones can be kept bound to their index.
+void UICollectionViewContentView::ClearVisibleItems(bool bKeepVersioned)
+{
+	// recycle all visible item controls, versioned ones filled at full quality may be handed back if they are up to date.
 	for (auto itr = m_Items.begin(); itr != m_Items.end(); itr ++) {
+		if (bKeepVersioned && itr->second->m_uVersion != 0 && m_ReducedQualityIndexes.count(itr->first) == 0) {
+			m_AffineItems[itr->first] = itr->second;
+			continue;
+		}
 		if (m_pDelegate) m_pDelegate->CollectionViewWillRecycleItem(m_pOwner, itr->second);
 		m_ItemsPool.push(itr->second);
 	}
 	m_Items.clear();
+	RecycleAffineItems(bKeepVersioned);
 	m_SelectionIndexes.clear();
 	m_LassoPersistedSelectionIndexes.clear();
+	m_ReducedQualityIndexes.clear();
+	m_BindQueue.Clear();
+	m_pTileCache->RemoveAll();
+}
+
+// Map the scroll velocity to the quality hint of newly displayed items.
+UICollectionViewItemQuality UICollectionViewContentView::GetItemQuality() const
+{
+	// a zero velocity threshold disables that quality.
+	if (m_nPlaceholderVelocity > 0 && m_fScrollVelocity >= m_nPlaceholderVelocity)
+		return UICollectionViewItemQualityPlaceholder;
+	if (m_nLowQualityVelocity > 0 && m_fScrollVelocity >= m_nLowQualityVelocity)
+		return UICollectionViewItemQualityLow;
+	return UICollectionViewItemQualityFull;
+}
+
+// Fill items displayed at a reduced quality again at full quality.
+void UICollectionViewContentView::RefillReducedQualityItems()
+{
+	if (!m_pDelegate) return;
+
+	std::set<int> sIndexes;
+	sIndexes.swap(m_ReducedQualityIndexes);
+	for (int i : sIndexes) {
+		auto itr = m_Items.find(i);
+		if (itr == m_Items.end()) {
+			if (m_AffineItems.count(i)) m_ReducedQualityIndexes.insert(i); // refilled once it is scrolled in.
+			continue;
+		}
+		if (m_pDelegate->CollectionViewWillDisplayItemWithQuality(m_pOwner, itr->second, i, UICollectionViewItemQualityFull) < UICollectionViewItemQualityFull)
+			m_ReducedQualityIndexes.insert(i);
+		itr->second->Invalidate();
+	}
+}
+
+// Request a layout pass without repainting the whole view, it only runs once a part of the window is invalid.
+void UICollectionViewContentView::NeedLayout()
+{
+	if (!m_pManager) return;
+
+	m_bLayoutOnly = true;
+	m_bUpdateNeeded = true;
+	m_pManager->NeedUpdate();
+}
+
+// Add a rect within the scrollable area to the dirty rects, which are invalidated by the running layout pass,
+// or by a timer outside of a layout pass.
+void UICollectionViewContentView::AddDirtyRect(const RECT &rc)
+{
+	if (!m_pManager) return;
+
+	// crop paint area with content view's client rect and all parents' client area, cached until the next layout.
+	if (!m_bDirtyClipValid) {
+		m_rcDirtyClip = m_rcScrollable;
+		CControlUI *pParent = this;
+		RECT rcTemp;
+		RECT rcParent;
+		while (pParent = pParent->GetParent()) {
+			rcTemp = m_rcDirtyClip;
+			rcParent = pParent->GetPos();
+			if (!::IntersectRect(&m_rcDirtyClip, &rcTemp, &rcParent))
+				break;
+		}
+		m_bDirtyClipValid = true;
+	}
+
+	RECT rcDirty = { 0 };
+	if (!::IntersectRect(&rcDirty, &rc, &m_rcDirtyClip)) return;
+	m_nDirtyRectsRaw ++;
+
+	// the first dirty rect outside of a layout pass schedules a flush, hovering an item doesn't need a layout.
+	if (m_DirtyRects.empty() && !m_bInLayout) {
+		m_pManager->SetTimer(this, TIMER_DIRTYRECTS, UICollectionViewDirtyRectsDelay);
+	}
+
+	// merge into a dirty rect if their union doesn't waste much area, e.g. neighbours in a row.
+	auto Area = [](const RECT &rc) { return (INT64)(rc.right - rc.left) * (rc.bottom - rc.top); };
+	RECT rcUnion = { 0 };
+	for (size_t i = 0; i < m_DirtyRects.size(); i ++) {
+		::UnionRect(&rcUnion, &m_DirtyRects[i], &rcDirty);
+		if (Area(rcUnion) * 4 <= (Area(m_DirtyRects[i]) + Area(rcDirty)) * 5) {
+			m_DirtyRects[i] = rcUnion;
+			return;
+		}
+	}
+
+	if (m_DirtyRects.size() < UICollectionViewMaxDirtyRects) {
+		m_DirtyRects.push_back(rcDirty);
+		return;
+	}
+
+	// the set is full, merge into the rect which grows least.
+	size_t nBest = 0;
+	INT64 nBestGrowth = -1;
+	for (size_t i = 0; i < m_DirtyRects.size(); i ++) {
+		::UnionRect(&rcUnion, &m_DirtyRects[i], &rcDirty);
+		INT64 nGrowth = Area(rcUnion) - Area(m_DirtyRects[i]);
+		if (nBestGrowth < 0 || nGrowth < nBestGrowth) {
+			nBest = i;
+			nBestGrowth = nGrowth;
+		}
+	}
+	::UnionRect(&m_DirtyRects[nBest], &m_DirtyRects[nBest], &rcDirty);
+}
+
+// Invalidate the dirty rects on screen.
+void UICollectionViewContentView::FlushDirtyRects()
+{
+	if (m_pManager) {
+		for (size_t i = 0; i < m_DirtyRects.size(); i ++) {
+			m_pManager->Invalidate(m_DirtyRects[i]);
+		}
+	}
+
+	m_nDirtyRectsMerged += m_DirtyRects.size();
+	m_DirtyRects.clear();
+}
+
+// Get counters of dirty rects added and invalidated.
+UICollectionViewDirtyRectStats UICollectionViewContentView::GetDirtyRectStats() const
+{
+	UICollectionViewDirtyRectStats stats;
+	stats.nRaw = m_nDirtyRectsRaw;
+	stats.nMerged = m_nDirtyRectsMerged;
+	return stats;
+}
+
+// Reset counters of dirty rects.
+void UICollectionViewContentView::ResetDirtyRectStats()
+{
+	m_nDirtyRectsRaw = m_nDirtyRectsMerged = 0;
+}
+
+// Invalidate visible items whose selection state changed.
+void UICollectionViewContentView::InvalidateSelectionChanges(const std::set<int> &sOldIndexes, const std::set<int> &sNewIndexes)
+{
+	int nColumns = m_Layout.GetColumns();
+	if (nColumns <= 0) return;
+
+	// the union of changed cells in each row, items may not be moved to the current viewport yet.
+	std::map<int, RECT> mRows;
+	auto AddChangedItem = [&](int nIndex) {
+		if (sOldIndexes.count(nIndex) == sNewIndexes.count(nIndex)) return;
+
+		RECT rcCell = GetItemPos(nIndex / nColumns, nIndex % nColumns);
+		InvalidateTiles(rcCell);
+
+		auto row = mRows.find(nIndex / nColumns);
+		if (row == mRows.end()) mRows[nIndex / nColumns] = rcCell;
+		else ::UnionRect(&row->second, &row->second, &rcCell);
+	};
+
+	// immediate mode has no item controls, visit visible cells instead.
+	if (m_bImmediateMode) {
+		for (int i = m_nVisibleFirst; i <= m_nVisibleLast; i ++) AddChangedItem(i);
+	} else {
+		for (auto itr = m_Items.begin(); itr != m_Items.end(); itr ++) AddChangedItem(itr->first);
+	}
+
+	// coalesce adjacent rows spanning the same columns, e.g. a lasso selects a block of cells.
+	RECT rcDirty = { 0 };
+	int nLastRow = -1;
+	for (auto itr = mRows.begin(); itr != mRows.end(); itr ++) {
+		if (nLastRow >= 0 && itr->first == nLastRow + 1 && itr->second.left == rcDirty.left && itr->second.right == rcDirty.right) {
+			rcDirty.bottom = itr->second.bottom;
+		} else {
+			if (nLastRow >= 0) AddDirtyRect(rcDirty);
+			rcDirty = itr->second;
+		}
+		nLastRow = itr->first;
+	}
+	if (nLastRow >= 0) AddDirtyRect(rcDirty);
+}
+
+// Shift the pixels of the scrollable area on screen by the scroll delta.
+bool UICollectionViewContentView::ScrollBlit(int nDelta)
+{
+	if (!m_bScrollBlit || !m_pManager || nDelta == 0) return false;
+
+	// layered windows have no screen pixels to shift, and the lasso has to be repainted anyway.
+	if (m_pManager->IsLayered() || (m_pSelectionLasso && m_pSelectionLasso->IsVisible())) return false;
+	if (abs(nDelta) >= m_rcScrollable.bottom - m_rcScrollable.top) return false;
+
+	// crop the scroll area with all parents' client area, pixels outside belong to other controls.
+	RECT rcScroll = m_rcScrollable;
+	RECT rcTemp;
+	RECT rcParent;
+	CControlUI *pParent = this;
+	while (pParent = pParent->GetParent()) {
+		rcTemp = rcScroll;
+		rcParent = pParent->GetPos();
+		if (!::IntersectRect(&rcScroll, &rcTemp, &rcParent))
+			return false;
+	}
+
+	// the exposed strip is invalidated, and pending invalid areas are shifted along with the pixels. queued dirty rects
+	// are in the coordinates before scrolling, they are invalidated first so they are shifted too.
+	FlushDirtyRects();
+	::ScrollWindowEx(m_pManager->GetPaintWindow(), 0, -nDelta, &rcScroll, &rcScroll, NULL, NULL, SW_INVALIDATE);
+	return true;
 }
 
 // Rewrite this method to hit test item controls inside `m_Items` map.
@@ -9,10 +9,18 @@
 
 #include "UIlib.h"
 #include "UICollectionViewItem.h"
+#include "UICollectionViewDelegate.h"
 #include "UICollectionViewLasso.h"
+#include "UICollectionViewLayout.h"
+#include "UICollectionViewThumbnailCache.h"
+#include "UICollectionViewThumbnailStore.h"
+#include "UICollectionViewTileCache.h"
+#include "UICollectionViewIdleScheduler.h"
+#include "UICollectionViewBindQueue.h"
 #include <map>
 #include <set>
 #include <stack>
+#include <vector>
 
 namespace DuiLib
 {
@@ -81,6 +89,9 @@ public:
 	// Remove all items.
 	void RemoveAll();
 
+	// Insert items at the indexes, numbered after the insertion. The data source must already contain them.
+	bool InsertAt(std::set<int> sIndexes);
+
 	// Item size (same for all item controls).
 	SIZE GetItemSize() const { return m_szItem; }
 
@@ -90,6 +101,36 @@ public:
 	// Return the item selection indexes.
 	std::set<int> GetSelectionIndexes() const { return m_SelectionIndexes; }
 
+	// Get the thumbnail cache shared by all items.
+	UICollectionViewThumbnailCache* GetThumbnailCache() const { return m_pThumbnailCache; }
+
+	// Get the persistent thumbnail store shared by all items.
+	UICollectionViewThumbnailStore* GetThumbnailStore() const { return m_pThumbnailStore; }
+
+	// Get the tile cache used as the backing store of the content view.
+	UICollectionViewTileCache* GetTileCache() const { return m_pTileCache; }
+
+	// Queue a low priority job, it runs in small slices while no input or paint message is waiting.
+	void PostIdleJob(const UICollectionViewIdleScheduler::Job &job);
+
+	// Repaint an item, e.g. its data changed outside of the delegate methods.
+	void InvalidateItemAtIndex(int nIndex);
+
+	// Get counters of items handed back bound to their index and filled via delegate.
+	UICollectionViewReuseStats GetReuseStats() const;
+
+	// Reset counters of reused items.
+	void ResetReuseStats();
+
+	// Get counters of dirty rects added and invalidated.
+	UICollectionViewDirtyRectStats GetDirtyRectStats() const;
+
+	// Reset counters of dirty rects.
+	void ResetDirtyRectStats();
+
+	// Get the smoothed scroll velocity in pixels per second, zero once scrolling settles.
+	double GetScrollVelocity() const { return m_fScrollVelocity; }
+
 	// Override this method to handle content scrolling.
 	virtual void SetScrollPos(SIZE szPos);
 
@@ -109,29 +150,146 @@ public:
 	void SetAttribute(LPCTSTR pstrName, LPCTSTR pstrValue);
 
 	// By default refresh internal cache and rebuild the whole view.
-	void ReloadData(BOOL bFullReload = TRUE);
+	void ReloadData(BOOL bFullReload = TRUE, BOOL bKeepState = FALSE);
+
+	// Fill items at the indexes again via delegate, the others are left untouched.
+	void ReloadItemsAtIndexes(const std::set<int> &sIndexes);
 
 protected:
 
-	// Clear all visible item controls.
-	void ClearVisibleItems();
+	// Clear all visible item controls, versioned ones can be kept bound to their index.
+	void ClearVisibleItems(bool bKeepVersioned = false);
+
+	// Map the scroll velocity to the quality hint of newly displayed items.
+	UICollectionViewItemQuality GetItemQuality() const;
+
+	// Fill items displayed at a reduced quality again at full quality.
+	void RefillReducedQualityItems();
+
+	// Paint items within the paint rect, return false if a part of it is not final, i.e. skeletons or reduced quality items.
+	bool PaintItems(HDC hDC, const RECT &rcPaint);
+
+	// Anchor the scroll position at the first visible item, the next layout keeps it at its offset in the viewport.
+	void SetScrollAnchor();
+
+	// Fill an item with the data at an index via delegate, and stamp it with the data version.
+	void FillItem(UICollectionViewItem *pItem, int nIndex, UICollectionViewItemQuality quality);
+
+	// Return true if an item was filled with the current version of the data at its index.
+	bool IsItemUpToDate(UICollectionViewItem *pItem, int nIndex) const;
+
+	// Take a recycled item still bound to an index out of the visible range, farthest from it first.
+	UICollectionViewItem* TakeAffineItem(int nIndexFirst, int nIndexLast);
+
+	// Recycle items still bound to their index, e.g. indexes are no longer valid. Versioned items can be kept, as their
+	// version tells whether they are still up to date.
+	void RecycleAffineItems(bool bKeepVersioned = false);
+
+	// Start the idle timer if jobs are queued.
+	void ScheduleIdleJobs();
+
+	// Create item controls into the pool in idle time, so the next rows scrolled in don't create them.
+	bool PrewarmItemsPool(UICollectionViewIdleScheduler *pScheduler);
+
+	// Create item controls into the pool until the scheduler yields, return true if more are needed.
+	bool PrewarmItems(UICollectionViewIdleScheduler *pScheduler);
+
+	// Paint the skeleton of an item which is not bound yet.
+	void PaintSkeletonItem(HDC hDC, const RECT &rcItem, const RECT &rcPaint);
+
+	// Paint an item without an item control in immediate mode.
+	void PaintImmediateItem(HDC hDC, int nIndex, const RECT &rcItem, const RECT &rcPaint);
+
+	// Get the index of the item at a point in window coordinates, -1 if there is none.
+	int GetItemIndexAtPoint(POINT pt) const;
+
+	// Track the item under the mouse in immediate mode, -1 if there is none.
+	void SetHotIndex(int nIndex);
+
+	// Move the focused item and the selection with arrow, page and HOME / END keys, SHIFT extends the selection
+	// from its anchor, CTRL only moves the focus and CTRL+SPACE toggles the focused item. Return false if the key
+	// isn't handled.
+	bool MoveFocusByKey(TCHAR chKey);
+
+	// Calculate item position (zero based, row, column) in window coordinates.
+	RECT GetItemPos(int nRow, int nColumn) const;
+
+	// Get the rows and columns of cells intersecting a rect in window coordinates, `rcRange` holds the first / last
+	// column in left / right, and the first / last row in top / bottom. Return false if no cell intersects.
+	bool GetItemRange(const RECT &rc, RECT &rcRange) const;
+
+	// Composite cached tiles, tiles missing from the cache are painted and cached if they are fully visible.
+	void PaintTiles(HDC hDC, const RECT &rcPaint);
+
+	// Invalidate cached tiles intersecting a rect in window coordinates.
+	void InvalidateTiles(const RECT &rc);
+
+	// Invalidate cached tiles of visible items at the indexes.
+	void InvalidateTiles(const std::set<int> &sIndexes);
+
+	// Invalidate cached tiles of the item at an index, wherever it is laid out.
+	void InvalidateTiles(int nIndex);
+
+	// Request a layout pass without repainting the whole view, it only runs once a part of the window is invalid.
+	void NeedLayout();
+
+	// Add a rect within the scrollable area to the dirty rects, which are invalidated by the running layout pass,
+	// or by a timer outside of a layout pass.
+	void AddDirtyRect(const RECT &rc);
+
+	// Invalidate the dirty rects on screen.
+	void FlushDirtyRects();
+
+	// Invalidate visible items whose selection state changed, coalesced into a rect per block of rows.
+	void InvalidateSelectionChanges(const std::set<int> &sOldIndexes, const std::set<int> &sNewIndexes);
+
+	// Shift the pixels of the scrollable area on screen by the scroll delta, so only the exposed strip
+	// has to be repainted. Return false if the whole view has to be repainted instead.
+	bool ScrollBlit(int nDelta);
 
 protected:
 
 	enum { // scrolling drag selection.
 		TIMER_SCROLLUP,
 		TIMER_SCROLLDN,
+		TIMER_SCROLLSETTLE, // scrolling has stopped for a while.
+		TIMER_ITEMDWELL, // pending items stayed visible for the dwell time.
+		TIMER_IDLE, // run idle jobs.
+		TIMER_DIRTYRECTS, // flush dirty rects added outside of a layout pass.
 	};
 
 	int m_nCount; // number of items to load.
-	int m_nColumns; // virtual columns.
-	int m_nRows; // virtual rows.
 	UINT m_uMouseState; // mouse (captured) state.
 	SIZE m_szItem; // size of each item (fixed).
 	SIZE m_szItemPadding; // padding between items.
-	SIZE m_szContent; // size of whole virtual area.
 	RECT m_rcScrollable; // scroll area (exclude inset and scrollbar).
 	POINT m_ptViewport; // origin of virtual area using default axis.
+	UICollectionViewLayout m_Layout; // flow layout of items, in content coordinates.
+	int m_nVisibleFirst; // index of the first visible item.
+	int m_nVisibleLast; // index of the last visible item, less than the first one if there is none.
+	UICollectionViewAnchor m_Anchor; // item kept in place by the next layout, its index is -1 if there is none.
+	BOOL m_bImmediateMode; // draw items with the delegate instead of item controls.
+	int m_nHotIndex; // item under the mouse in immediate mode.
+	int m_nFocusIndex; // item moved by keyboard, -1 if there is none.
+	int m_nSelectionAnchor; // item a SHIFT selection extends from, -1 if there is none.
+	double m_fScrollVelocity; // smoothed scroll velocity, pixels per second.
+	LARGE_INTEGER m_liLastScroll; // performance counter of the last scroll.
+	int m_nLowQualityVelocity; // items are filled at low quality above this velocity.
+	int m_nPlaceholderVelocity; // items are filled with placeholders above this velocity.
+	bool m_bScrolling; // scrolled within the settle delay.
+	int m_nScrollDirection; // direction of the last scroll, 1 down, -1 up, 0 not scrolled.
+	int m_nRecycleHysteresis; // pixels items are kept outside of the viewport before being recycled.
+	UICollectionViewBindQueue m_BindQueue; // decides when items are bound, visible items may stay skeletons.
+	BOOL m_bScrollBlit; // scroll by shifting pixels on screen.
+	bool m_bLayoutOnly; // the next layout must not invalidate the view, pixels are shifted or invalidated precisely.
+	BOOL m_bTileCache; // paint through the tile cache.
+	SIZE m_szTiledContent; // content size the cached tiles were painted for.
+	bool m_bInLayout; // dirty rects are flushed by the running layout pass.
+	bool m_bDirtyClipValid; // the clip rect of dirty rects is up to date.
+	RECT m_rcDirtyClip; // scrollable area cropped with all parents' client area.
+	std::vector<RECT> m_DirtyRects; // merged dirty rects.
+	UINT64 m_nDirtyRectsRaw; // dirty rects added.
+	UINT64 m_nDirtyRectsMerged; // dirty rects invalidated after merging.
 
 	UICollectionViewItemAttributes m_ItemAttributes; // shared item attributes.
 	UICollectionViewLassoAttributes m_LassoAttributes; // selection lasso attributes.
@@ -139,10 +297,19 @@ protected:
 	UICollectionView *m_pOwner; // public visible host.
 	UICollectionViewDelegate *m_pDelegate; // collection view's delegate.
 	UICollectionViewLasso *m_pSelectionLasso; // drag selection support.
+	UICollectionViewThumbnailCache *m_pThumbnailCache; // decoded thumbnails of items.
+	UICollectionViewThumbnailStore *m_pThumbnailStore; // thumbnails persisted across launches.
+	UICollectionViewTileCache *m_pTileCache; // backing store of painted items.
+	UICollectionViewIdleScheduler *m_pIdleScheduler; // low priority jobs.
+	bool m_bPrewarmQueued; // a job pre-warming the item pool is queued.
 	std::map<int, UICollectionViewItem *> m_Items; // visible items.
 	std::stack<UICollectionViewItem *> m_ItemsPool; // recycled items.
+	std::map<int, UICollectionViewItem *> m_AffineItems; // scrolled out items still bound to their index.
+	UINT64 m_nReuseHits; // items handed back bound to their index.
+	UINT64 m_nReuseMisses; // items filled via delegate.
 	std::set<int> m_SelectionIndexes; // track item selections.
 	std::set<int> m_LassoPersistedSelectionIndexes; // save selections before drag selection.
+	std::set<int> m_ReducedQualityIndexes; // visible items filled below full quality.
 
 };
 
@@ -13,6 +13,14 @@
 namespace DuiLib
 {
 
+// Quality hint for filling data into an item, decided by the scroll velocity. Items filled at a reduced
+// quality will be filled again at full quality once scrolling settles.
+enum UICollectionViewItemQuality {
+	UICollectionViewItemQualityPlaceholder,	// scrolling too fast to see anything, e.g. a scrollbar thumb drag.
+	UICollectionViewItemQualityLow,			// fast scrolling, only use what is cheap, e.g. cached thumbnails.
+	UICollectionViewItemQualityFull,		// not scrolling or slow scrolling.
+};
+
 // Delegate methods to lazy loading items and their data.
 class UICollectionView;
 class UICollectionViewItem;
@@ -31,6 +39,13 @@ public:
 
 public: // Optional
 
+	// Same as `CollectionViewWillDisplayItem`, but with a quality hint decided by the scroll velocity. Return the quality the
+	// item was actually filled at, the item will be filled again at full quality once scrolling settles if it is lower.
+	virtual UICollectionViewItemQuality CollectionViewWillDisplayItemWithQuality(UICollectionView *pCollectionView, UICollectionViewItem *pItemView, int nItemIndex, UICollectionViewItemQuality quality) {
+		CollectionViewWillDisplayItem(pCollectionView, pItemView, nItemIndex);
+		return UICollectionViewItemQualityFull;
+	}
+
 	// Collection view assumes all items are in the same size and will be resized automatically.
 	virtual SIZE CollectionViewItemSize(UICollectionView *pCollectionView) { SIZE szItem = {0, 0}; return szItem; }
 
@@ -40,7 +55,16 @@ public: // Optional
 	// User is explicitly removing one or many items. Make sure you've updated your data source accordingly within this method.
 	virtual void CollectionViewWillRemoveItemsAtIndexes(UICollectionView *pCollectionView, std::set<int> indexes) {}
 
-	// The collection view is about to recycle an item for reuse. Use this method to clean up resources.
+	// Return a version of the data at an index, e.g. a hash of the fields shown or a revision counter, it must change when
+	// the data shown at the index changes. Items are stamped with it when filled; an item handed back to its index, also
+	// after `ReloadData()`, or reloaded by `ReloadItemsAtIndexes(...)` isn't filled again while the version is unchanged.
+	// Zero means unversioned, such items are always filled.
+	virtual UINT64 CollectionViewVersionForItemAtIndex(UICollectionView *pCollectionView, int nItemIndex) { return 0; }
+
+	// The collection view is about to recycle an item for reuse. Use this method to clean up resources. An item scrolled out
+	// stays bound to its index and is only recycled once it is reused for another index, or the data is reloaded. The item
+	// is still laid out where it was displayed last, so don't invalidate it or its children here, it is filled and
+	// repainted at its new position right after.
 	virtual void CollectionViewWillRecycleItem(UICollectionView *pCollectionView, UICollectionViewItem *pItemView) {}
 
 	// User selected or deselected one or many items. The internal selection indexes were updated before visiting this method.
@@ -49,7 +73,16 @@ public: // Optional
 	// Visited when the collection view updated item's position. Don't put any time consuming code in this method.
 	virtual void CollectionViewDidUpdateItemLayout(UICollectionView *pCollectionView, UICollectionViewItem *pItemView, int nItemIndex) {}
 
-	// User double clicked on an item.
+	// Return TRUE to draw items with `CollectionViewDrawItem` instead of creating an item control per visible item, read by
+	// `ReloadData()`. Hit testing, hover and selection keep working; `pItemView` is nullptr in delegate methods then, and
+	// `CollectionViewReusableItemTemplate` / `CollectionViewWillDisplayItem` are never visited.
+	virtual BOOL CollectionViewShouldDrawItemsImmediately(UICollectionView *pCollectionView) { return FALSE; }
+
+	// Draw the content of an item in immediate mode, its background and border are already painted with the item attributes
+	// of its state (0, UISTATE_HOT, UISTATE_SELECTED or UISTATE_DISABLED). The DC is clipped to `rcPaint`.
+	virtual void CollectionViewDrawItem(UICollectionView *pCollectionView, HDC hDC, const RECT &rcItem, const RECT &rcPaint, int nItemIndex, UINT uState) {}
+
+	// User double clicked on an item. `pItemView` is nullptr in immediate mode, the item is only known by `nItemIndex`.
 	virtual void CollectionViewDidDoubleClickItem(UICollectionView *pCollectionView, UICollectionViewItem *pItemView, int nItemIndex) {}
 
 	// User has explicitly removed one or many items from collection view.
@@ -0,0 +1,32 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+namespace DuiLib
+{
+
+// Plain geometry types of the portable parts of the collection view, laid out like Win32 RECT / SIZE / POINT
+// so the DuiLib controls can convert them member by member.
+
+// A rect, right and bottom are exclusive.
+struct UICollectionViewRect
+{
+	int left;
+	int top;
+	int right;
+	int bottom;
+};
+
+// A size.
+struct UICollectionViewSize
+{
+	int cx;
+	int cy;
+};
+
+}
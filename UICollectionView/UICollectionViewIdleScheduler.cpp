@@ -0,0 +1,65 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewIdleScheduler.h"
+
+namespace DuiLib
+{
+
+// Constructor.
+UICollectionViewIdleScheduler::UICollectionViewIdleScheduler(UINT uSliceTime)
+	:m_uSliceTime(uSliceTime)
+{
+	memset(&m_liDeadline, 0, sizeof(LARGE_INTEGER));
+}
+
+// Queue a job, it runs after the queued ones.
+void UICollectionViewIdleScheduler::Post(const Job &job)
+{
+	if (job) m_Jobs.push_back(job);
+}
+
+// Remove all queued jobs.
+void UICollectionViewIdleScheduler::RemoveAll()
+{
+	m_Jobs.clear();
+}
+
+// Run queued jobs for a time slice, return true if jobs are left.
+bool UICollectionViewIdleScheduler::Run()
+{
+	LARGE_INTEGER liFrequency;
+	::QueryPerformanceCounter(&m_liDeadline);
+	::QueryPerformanceFrequency(&liFrequency);
+	m_liDeadline.QuadPart += liFrequency.QuadPart * m_uSliceTime / 1000;
+
+	// jobs are taken off the queue while running, they may post or remove jobs.
+	while (!m_Jobs.empty() && !ShouldYield()) {
+		Job job = m_Jobs.front();
+		m_Jobs.pop_front();
+		if (job(this)) m_Jobs.push_back(job);
+	}
+	return !m_Jobs.empty();
+}
+
+// Return true if the running job should return.
+bool UICollectionViewIdleScheduler::ShouldYield() const
+{
+	LARGE_INTEGER liNow;
+	::QueryPerformanceCounter(&liNow);
+	return liNow.QuadPart >= m_liDeadline.QuadPart || IsInputPending();
+}
+
+// Return true if an input or paint message is waiting.
+bool UICollectionViewIdleScheduler::IsInputPending()
+{
+	// the high word has the types of messages currently in the queue, the low word only the new ones.
+	return HIWORD(::GetQueueStatus(QS_INPUT | QS_PAINT)) != 0;
+}
+
+}
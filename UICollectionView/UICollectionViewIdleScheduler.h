@@ -0,0 +1,65 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+#include <deque>
+#include <functional>
+
+namespace DuiLib
+{
+
+// Default time slice of idle jobs in milliseconds.
+static const UINT UICollectionViewIdleDefaultSliceTime = 4;
+
+// Runs low priority jobs, e.g. pre-warming the item pool or prefetching thumbnails, while the thread
+// would be idle otherwise. The content view drives it with a timer, whose messages are only generated
+// when the queue is empty; jobs then run round robin in small slices and yield as soon as an input or
+// paint message arrives, so they never delay input handling and layout.
+class UICollectionViewIdleScheduler
+{
+public:
+
+	// A job does a small unit of work until `ShouldYield()`, return true if it has work left.
+	typedef std::function<bool(UICollectionViewIdleScheduler *pScheduler)> Job;
+
+	// Constructor.
+	UICollectionViewIdleScheduler(UINT uSliceTime = UICollectionViewIdleDefaultSliceTime);
+
+	// Queue a job, it runs after the queued ones.
+	void Post(const Job &job);
+
+	// Remove all queued jobs.
+	void RemoveAll();
+
+	// Return true if no job is queued.
+	bool IsEmpty() const { return m_Jobs.empty(); }
+
+	// Get the time slice in milliseconds.
+	UINT GetSliceTime() const { return m_uSliceTime; }
+
+	// Set the time slice in milliseconds.
+	void SetSliceTime(UINT uSliceTime) { m_uSliceTime = uSliceTime; }
+
+	// Run queued jobs for a time slice, return true if jobs are left.
+	bool Run();
+
+	// Return true if the running job should return, the slice is used up or a message is waiting.
+	bool ShouldYield() const;
+
+	// Return true if an input or paint message is waiting in the queue of the calling thread.
+	static bool IsInputPending();
+
+private:
+
+	std::deque<Job> m_Jobs; // queued jobs.
+	UINT m_uSliceTime; // time slice in milliseconds.
+	LARGE_INTEGER m_liDeadline; // performance counter the running slice ends at.
+};
+
+}
@@ -0,0 +1,413 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewImageScaler.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define UICOLLECTIONVIEW_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define UICOLLECTIONVIEW_TARGET_AVX2
+#else
+#define UICOLLECTIONVIEW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace DuiLib
+{
+
+// Weights are fixed point numbers with 14 fraction bits.
+static const int WeightBits = 14;
+static const int WeightOne = 1 << WeightBits;
+static const int WeightRound = 1 << (WeightBits - 1);
+
+// Source pixels contributing to a destination pixel.
+struct Contribution
+{
+	int nFirst; // first source pixel.
+	int nCount; // number of source pixels.
+	int nWeights; // offset of the first weight.
+};
+
+// Contributions of all destination pixels along one axis.
+struct Contributions
+{
+	std::vector<Contribution> Pixels;
+	std::vector<int16_t> Weights;
+};
+
+// Clamp an accumulated value into a channel.
+static inline uint32_t ClampChannel(int nValue)
+{
+	nValue = (nValue + WeightRound) >> WeightBits;
+	return nValue < 0 ? 0 : (nValue > 255 ? 255 : (uint32_t)nValue);
+}
+
+// Evaluate the filter kernel.
+static double Kernel(UICollectionViewImageScaler::Filter filter, double x)
+{
+	static const double Pi = 3.14159265358979323846;
+	if (x < 0) x = -x;
+
+	switch (filter) {
+	case UICollectionViewImageScaler::FilterBox:
+		return x <= 0.5 ? 1.0 : 0.0;
+	case UICollectionViewImageScaler::FilterBilinear:
+		return x < 1.0 ? 1.0 - x : 0.0;
+	case UICollectionViewImageScaler::FilterLanczos:
+		if (x < 1e-8) return 1.0;
+		if (x >= 3.0) return 0.0;
+		return (3.0 * sin(Pi * x) * sin(Pi * x / 3.0)) / (Pi * Pi * x * x);
+	}
+	return 0.0;
+}
+
+// Get the radius of the filter kernel.
+static double Support(UICollectionViewImageScaler::Filter filter)
+{
+	switch (filter) {
+	case UICollectionViewImageScaler::FilterBox: return 0.5;
+	case UICollectionViewImageScaler::FilterBilinear: return 1.0;
+	case UICollectionViewImageScaler::FilterLanczos: return 3.0;
+	}
+	return 1.0;
+}
+
+// Compute normalized fixed point weights of each destination pixel.
+static void ComputeContributions(int nSrc, int nDst, UICollectionViewImageScaler::Filter filter, Contributions &contribs)
+{
+	// the kernel is stretched when downscaling, so every source pixel contributes.
+	double fScale = (double)nDst / nSrc;
+	double fFilterScale = fScale < 1.0 ? 1.0 / fScale : 1.0;
+	double fSupport = Support(filter) * fFilterScale;
+
+	contribs.Pixels.resize(nDst);
+	contribs.Weights.clear();
+	std::vector<double> weights;
+
+	for (int i = 0; i < nDst; i ++) {
+		double fCenter = (i + 0.5) / fScale;
+		int nFirst = (int)floor(fCenter - fSupport);
+		int nLast = (int)ceil(fCenter + fSupport);
+		if (nFirst < 0) nFirst = 0;
+		if (nLast > nSrc - 1) nLast = nSrc - 1;
+
+		weights.clear();
+		double fSum = 0;
+		for (int j = nFirst; j <= nLast; j ++) {
+			double fWeight = Kernel(filter, (j + 0.5 - fCenter) / fFilterScale);
+			weights.push_back(fWeight);
+			fSum += fWeight;
+		}
+
+		// fall back to the nearest pixel if the kernel missed all pixels.
+		if (fSum == 0) {
+			int nNearest = (int)fCenter;
+			if (nNearest > nLast) nNearest = nLast;
+			for (size_t j = 0; j < weights.size(); j ++) weights[j] = 0;
+			weights[nNearest - nFirst] = 1.0;
+			fSum = 1.0;
+		}
+
+		// trim zero weights at both ends.
+		size_t nBegin = 0, nEnd = weights.size();
+		while (nBegin + 1 < nEnd && weights[nBegin] == 0) nBegin ++;
+		while (nEnd - 1 > nBegin && weights[nEnd - 1] == 0) nEnd --;
+
+		// normalize, the rounding error goes to the largest weight.
+		Contribution &contrib = contribs.Pixels[i];
+		contrib.nFirst = nFirst + (int)nBegin;
+		contrib.nCount = (int)(nEnd - nBegin);
+		contrib.nWeights = (int)contribs.Weights.size();
+		int nTotal = 0;
+		size_t nLargest = nBegin;
+		for (size_t j = nBegin; j < nEnd; j ++) {
+			int16_t nWeight = (int16_t)floor(weights[j] / fSum * WeightOne + 0.5);
+			contribs.Weights.push_back(nWeight);
+			nTotal += nWeight;
+			if (weights[j] > weights[nLargest]) nLargest = j;
+		}
+		contribs.Weights[contrib.nWeights + (nLargest - nBegin)] += (int16_t)(WeightOne - nTotal);
+	}
+}
+
+// Resample one row, scalar version.
+static void ScaleRowScalar(const uint32_t *pSrc, uint32_t *pDst, const Contributions &contribs)
+{
+	for (size_t i = 0; i < contribs.Pixels.size(); i ++) {
+		const Contribution &contrib = contribs.Pixels[i];
+		const int16_t *pWeights = &contribs.Weights[contrib.nWeights];
+		const uint32_t *pPixels = pSrc + contrib.nFirst;
+		int nB = 0, nG = 0, nR = 0, nA = 0;
+		for (int k = 0; k < contrib.nCount; k ++) {
+			uint32_t nPixel = pPixels[k];
+			nB += (int)(nPixel & 0xFF) * pWeights[k];
+			nG += (int)((nPixel >> 8) & 0xFF) * pWeights[k];
+			nR += (int)((nPixel >> 16) & 0xFF) * pWeights[k];
+			nA += (int)(nPixel >> 24) * pWeights[k];
+		}
+		pDst[i] = ClampChannel(nB) | (ClampChannel(nG) << 8) | (ClampChannel(nR) << 16) | (ClampChannel(nA) << 24);
+	}
+}
+
+// Resample one column of rows into a destination row, scalar version.
+static void ScaleColumnScalar(const uint32_t *const *pRows, const int16_t *pWeights, int nCount, uint32_t *pDst, int nFrom, int nWidth)
+{
+	for (int x = nFrom; x < nWidth; x ++) {
+		int nB = 0, nG = 0, nR = 0, nA = 0;
+		for (int k = 0; k < nCount; k ++) {
+			uint32_t nPixel = pRows[k][x];
+			nB += (int)(nPixel & 0xFF) * pWeights[k];
+			nG += (int)((nPixel >> 8) & 0xFF) * pWeights[k];
+			nR += (int)((nPixel >> 16) & 0xFF) * pWeights[k];
+			nA += (int)(nPixel >> 24) * pWeights[k];
+		}
+		pDst[x] = ClampChannel(nB) | (ClampChannel(nG) << 8) | (ClampChannel(nR) << 16) | (ClampChannel(nA) << 24);
+	}
+}
+
+#ifdef UICOLLECTIONVIEW_X86
+
+// Pack two weights for `_mm_madd_epi16`, the first one in the low half.
+static inline int PackWeights(int16_t nFirst, int16_t nSecond)
+{
+	return (int)(((uint32_t)(uint16_t)nSecond << 16) | (uint16_t)nFirst);
+}
+
+// Resample one row, SSE2 version, two source pixels per multiply.
+static void ScaleRowSSE2(const uint32_t *pSrc, uint32_t *pDst, const Contributions &contribs)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(WeightRound);
+
+	for (size_t i = 0; i < contribs.Pixels.size(); i ++) {
+		const Contribution &contrib = contribs.Pixels[i];
+		const int16_t *pWeights = &contribs.Weights[contrib.nWeights];
+		const uint32_t *pPixels = pSrc + contrib.nFirst;
+		__m128i acc = zero;
+
+		int k = 0;
+		for (; k + 1 < contrib.nCount; k += 2) {
+			// interleave channels of both pixels: b0 b1 g0 g1 r0 r1 a0 a1.
+			__m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pPixels + k)), zero);
+			px = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(PackWeights(pWeights[k], pWeights[k + 1]))));
+		}
+		if (k < contrib.nCount) {
+			__m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)pPixels[k]), zero);
+			px = _mm_unpacklo_epi16(px, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(PackWeights(pWeights[k], 0))));
+		}
+
+		acc = _mm_srai_epi32(_mm_add_epi32(acc, round), WeightBits);
+		acc = _mm_packs_epi32(acc, acc);
+		pDst[i] = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+	}
+}
+
+// Resample one column of rows into a destination row, SSE2 version, four pixels at a time.
+static void ScaleColumnSSE2(const uint32_t *const *pRows, const int16_t *pWeights, int nCount, uint32_t *pDst, int nFrom, int nWidth)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(WeightRound);
+
+	int x = nFrom;
+	for (; x + 4 <= nWidth; x += 4) {
+		__m128i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+		for (int k = 0; k < nCount; k += 2) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(pRows[k] + x));
+			__m128i b = (k + 1 < nCount) ? _mm_loadu_si128((const __m128i *)(pRows[k + 1] + x)) : zero;
+			__m128i weights = _mm_set1_epi32(PackWeights(pWeights[k], (k + 1 < nCount) ? pWeights[k + 1] : 0));
+
+			// interleave channels of both rows, so each multiply-add takes a weight pair.
+			__m128i aLo = _mm_unpacklo_epi8(a, zero), aHi = _mm_unpackhi_epi8(a, zero);
+			__m128i bLo = _mm_unpacklo_epi8(b, zero), bHi = _mm_unpackhi_epi8(b, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(aLo, bLo), weights));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(aLo, bLo), weights));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(aHi, bHi), weights));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(aHi, bHi), weights));
+		}
+
+		acc0 = _mm_srai_epi32(_mm_add_epi32(acc0, round), WeightBits);
+		acc1 = _mm_srai_epi32(_mm_add_epi32(acc1, round), WeightBits);
+		acc2 = _mm_srai_epi32(_mm_add_epi32(acc2, round), WeightBits);
+		acc3 = _mm_srai_epi32(_mm_add_epi32(acc3, round), WeightBits);
+		__m128i lo = _mm_packs_epi32(acc0, acc1);
+		__m128i hi = _mm_packs_epi32(acc2, acc3);
+		_mm_storeu_si128((__m128i *)(pDst + x), _mm_packus_epi16(lo, hi));
+	}
+
+	ScaleColumnScalar(pRows, pWeights, nCount, pDst, x, nWidth);
+}
+
+// Resample one column of rows into a destination row, AVX2 version, eight pixels at a time.
+// Unpack and pack instructions work within 128 bits lanes, so the pixel order is preserved.
+UICOLLECTIONVIEW_TARGET_AVX2
+static void ScaleColumnAVX2(const uint32_t *const *pRows, const int16_t *pWeights, int nCount, uint32_t *pDst, int nFrom, int nWidth)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi32(WeightRound);
+
+	int x = nFrom;
+	for (; x + 8 <= nWidth; x += 8) {
+		__m256i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+		for (int k = 0; k < nCount; k += 2) {
+			__m256i a = _mm256_loadu_si256((const __m256i *)(pRows[k] + x));
+			__m256i b = (k + 1 < nCount) ? _mm256_loadu_si256((const __m256i *)(pRows[k + 1] + x)) : zero;
+			__m256i weights = _mm256_set1_epi32(PackWeights(pWeights[k], (k + 1 < nCount) ? pWeights[k + 1] : 0));
+
+			__m256i aLo = _mm256_unpacklo_epi8(a, zero), aHi = _mm256_unpackhi_epi8(a, zero);
+			__m256i bLo = _mm256_unpacklo_epi8(b, zero), bHi = _mm256_unpackhi_epi8(b, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(aLo, bLo), weights));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(aLo, bLo), weights));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(aHi, bHi), weights));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(aHi, bHi), weights));
+		}
+
+		acc0 = _mm256_srai_epi32(_mm256_add_epi32(acc0, round), WeightBits);
+		acc1 = _mm256_srai_epi32(_mm256_add_epi32(acc1, round), WeightBits);
+		acc2 = _mm256_srai_epi32(_mm256_add_epi32(acc2, round), WeightBits);
+		acc3 = _mm256_srai_epi32(_mm256_add_epi32(acc3, round), WeightBits);
+		__m256i lo = _mm256_packs_epi32(acc0, acc1);
+		__m256i hi = _mm256_packs_epi32(acc2, acc3);
+		_mm256_storeu_si256((__m256i *)(pDst + x), _mm256_packus_epi16(lo, hi));
+	}
+
+	// the remaining pixels are fewer than eight.
+	ScaleColumnSSE2(pRows, pWeights, nCount, pDst, x, nWidth);
+}
+
+#endif // UICOLLECTIONVIEW_X86
+
+// Detect the best implementation supported by the CPU.
+static UICollectionViewImageScaler::Path DetectPath()
+{
+#if defined(UICOLLECTIONVIEW_X86) && defined(_MSC_VER)
+	int info[4] = { 0 };
+	__cpuid(info, 0);
+	int nMaxLeaf = info[0];
+	__cpuid(info, 1);
+	bool bSSE2 = (info[3] & (1 << 26)) != 0;
+	bool bOSXSave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+	if (bOSXSave && nMaxLeaf >= 7 && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		if ((info[1] & (1 << 5)) != 0) return UICollectionViewImageScaler::PathAVX2;
+	}
+	return bSSE2 ? UICollectionViewImageScaler::PathSSE2 : UICollectionViewImageScaler::PathScalar;
+#elif defined(UICOLLECTIONVIEW_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return UICollectionViewImageScaler::PathAVX2;
+	if (__builtin_cpu_supports("sse2")) return UICollectionViewImageScaler::PathSSE2;
+	return UICollectionViewImageScaler::PathScalar;
+#else
+	return UICollectionViewImageScaler::PathScalar;
+#endif
+}
+
+// The implementation in use and the best one supported, detected on first use. Scale may run on
+// worker threads, detection is idempotent so threads racing to detect store the same value.
+static std::atomic<int> s_nPath(-1);
+static std::atomic<int> s_nSupported(-1);
+
+// Resample the source image into the destination image, strides are in pixels.
+bool UICollectionViewImageScaler::Scale(const uint32_t *pSrc, int nSrcWidth, int nSrcHeight, int nSrcStride,
+	uint32_t *pDst, int nDstWidth, int nDstHeight, int nDstStride, Filter filter)
+{
+	if (!pSrc || !pDst || nSrcWidth <= 0 || nSrcHeight <= 0 || nDstWidth <= 0 || nDstHeight <= 0 ||
+		nSrcStride < nSrcWidth || nDstStride < nDstWidth) return false;
+
+	Path path = GetPath();
+	Contributions horizontal, vertical;
+	ComputeContributions(nSrcWidth, nDstWidth, filter, horizontal);
+	ComputeContributions(nSrcHeight, nDstHeight, filter, vertical);
+
+	// resample rows which are used by the vertical pass only.
+	int nRowFirst = vertical.Pixels.front().nFirst;
+	int nRowLast = vertical.Pixels.back().nFirst + vertical.Pixels.back().nCount - 1;
+	std::vector<uint32_t> intermediate;
+	intermediate.resize((size_t)nDstWidth * (nRowLast - nRowFirst + 1));
+	for (int y = nRowFirst; y <= nRowLast; y ++) {
+		const uint32_t *pSrcRow = pSrc + (size_t)y * nSrcStride;
+		uint32_t *pRow = &intermediate[(size_t)(y - nRowFirst) * nDstWidth];
+#ifdef UICOLLECTIONVIEW_X86
+		if (path != PathScalar) { ScaleRowSSE2(pSrcRow, pRow, horizontal); continue; }
+#endif
+		ScaleRowScalar(pSrcRow, pRow, horizontal);
+	}
+
+	// resample columns into the destination.
+	std::vector<const uint32_t *> rows;
+	for (int i = 0; i < nDstHeight; i ++) {
+		const Contribution &contrib = vertical.Pixels[i];
+		const int16_t *pWeights = &vertical.Weights[contrib.nWeights];
+		uint32_t *pDstRow = pDst + (size_t)i * nDstStride;
+
+		rows.resize(contrib.nCount);
+		for (int k = 0; k < contrib.nCount; k ++)
+			rows[k] = &intermediate[(size_t)(contrib.nFirst + k - nRowFirst) * nDstWidth];
+
+#ifdef UICOLLECTIONVIEW_X86
+		if (path == PathAVX2) ScaleColumnAVX2(&rows[0], pWeights, contrib.nCount, pDstRow, 0, nDstWidth);
+		else if (path == PathSSE2) ScaleColumnSSE2(&rows[0], pWeights, contrib.nCount, pDstRow, 0, nDstWidth);
+		else
+#endif
+		ScaleColumnScalar(&rows[0], pWeights, contrib.nCount, pDstRow, 0, nDstWidth);
+
+		// negative lobes may ring above alpha, which is invalid for premultiplied pixels.
+		if (filter == FilterLanczos) {
+			for (int x = 0; x < nDstWidth; x ++) {
+				uint32_t nPixel = pDstRow[x];
+				uint32_t nA = nPixel >> 24;
+				uint32_t nB = nPixel & 0xFF, nG = (nPixel >> 8) & 0xFF, nR = (nPixel >> 16) & 0xFF;
+				if (nB > nA) nB = nA;
+				if (nG > nA) nG = nA;
+				if (nR > nA) nR = nA;
+				pDstRow[x] = nB | (nG << 8) | (nR << 16) | (nA << 24);
+			}
+		}
+	}
+
+	return true;
+}
+
+// Get the implementation in use.
+UICollectionViewImageScaler::Path UICollectionViewImageScaler::GetPath()
+{
+	int nPath = s_nPath.load();
+	if (nPath < 0) {
+		// keep a path forced by another thread meanwhile.
+		int nExpected = -1;
+		nPath = GetSupportedPath();
+		if (!s_nPath.compare_exchange_strong(nExpected, nPath)) nPath = nExpected;
+	}
+	return (Path)nPath;
+}
+
+// Force an implementation, e.g. to compare them, a path not supported by the CPU is ignored.
+void UICollectionViewImageScaler::SetPath(Path path)
+{
+	if (path <= GetSupportedPath()) s_nPath = path;
+}
+
+// Return the best implementation supported by the CPU.
+UICollectionViewImageScaler::Path UICollectionViewImageScaler::GetSupportedPath()
+{
+	int nSupported = s_nSupported.load();
+	if (nSupported < 0) {
+		nSupported = DetectPath();
+		s_nSupported.store(nSupported);
+	}
+	return (Path)nSupported;
+}
+
+}
@@ -0,0 +1,55 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace DuiLib
+{
+
+// Resample 32bpp premultiplied BGRA images, used to produce item previews at the item size once
+// instead of asking GDI to stretch the full size image on every paint. The scaler is separable,
+// it resamples rows into an intermediate image and then columns into the destination, using
+// fixed point weights. The inner loops have SSE2 and AVX2 versions, the fastest one supported by
+// the CPU is selected at runtime and the scalar version is used everywhere else.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewImageScaler
+{
+public:
+
+	// Resampling filters, from the fastest to the sharpest.
+	enum Filter {
+		FilterBox,			// average of the covered source pixels.
+		FilterBilinear,		// triangle filter, widened when downscaling.
+		FilterLanczos,		// 3-lobed Lanczos filter.
+	};
+
+	// Implementations of the inner loops.
+	enum Path {
+		PathScalar,
+		PathSSE2,
+		PathAVX2,
+	};
+
+	// Resample the source image into the destination image, strides are in pixels.
+	// Return false if a size is invalid or out of memory.
+	static bool Scale(const uint32_t *pSrc, int nSrcWidth, int nSrcHeight, int nSrcStride,
+		uint32_t *pDst, int nDstWidth, int nDstHeight, int nDstStride, Filter filter = FilterBilinear);
+
+	// Get the implementation in use.
+	static Path GetPath();
+
+	// Force an implementation, e.g. to compare them, a path not supported by the CPU is ignored.
+	static void SetPath(Path path);
+
+	// Return the best implementation supported by the CPU.
+	static Path GetSupportedPath();
+};
+
+}
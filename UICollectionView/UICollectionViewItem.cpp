@@ -10,6 +10,7 @@
 #include "UICollectionViewLasso.h"
 #include "UICollectionViewContentView.h"
 #include "UICollectionViewDelegate.h"
+#include "UICollectionViewSolidFill.h"
 
 namespace DuiLib
 {
@@ -17,18 +18,33 @@ namespace DuiLib
 // Constructor.
 UICollectionViewItem::UICollectionViewItem() : 
 	m_nIndex(-1),
+	m_uVersion(0),
 	m_uMouseState(0),
+	m_bRasterize(FALSE),
+	m_hRaster(NULL),
+	m_nRasterIndex(-1),
+	m_uRasterState(0),
+	m_bRasterStale(false),
 	m_pCaption(nullptr),
 	m_pPreview(nullptr),
 	m_pContentView(nullptr)
 {
+	memset(&m_szRaster, 0, sizeof(SIZE));
+}
+
+// Destructor.
+UICollectionViewItem::~UICollectionViewItem()
+{
+	ReleaseRaster();
 }
 
 // Save item index into item control.
 void UICollectionViewItem::DoInit()
 {
 	m_nIndex = -1;
+	m_uVersion = 0;
 	m_uMouseState = 0;
+	ReleaseRaster(); // re-bound to other data.
 
 	m_pCaption = dynamic_cast<CLabelUI *>(FindSubControl(UICollectionViewItemCaption));
 	m_pPreview = dynamic_cast<CControlUI *>(FindSubControl(UICollectionViewItemPreview));
@@ -88,12 +104,14 @@ bool UICollectionViewItem::DoPaint(HDC hDC, const RECT& rcPaint, CControlUI *pSt
 	m_cxyBorderRound = sz;
 	m_rcBorderSize.top = m_rcBorderSize.left = m_rcBorderSize.right =
 		m_rcBorderSize.bottom = pInfo->nBorderWidth;
+	UINT uState = 0; // visual state.
 
 	// support item disabled state.
 	if (!IsEnabled()) {
 		m_dwBackColor = pInfo->dwDisabledBkColor;
 		m_dwBackColor2 = pInfo->dwDisabledBkColor;
 		m_dwBorderColor = pInfo->dwDisabledBdColor;
+		uState = UISTATE_DISABLED;
 	} 
 	
 	// support item selection state.
@@ -102,6 +120,7 @@ bool UICollectionViewItem::DoPaint(HDC hDC, const RECT& rcPaint, CControlUI *pSt
 		m_dwBackColor = pInfo->dwSelectedBkColor;
 		m_dwBackColor2 = pInfo->dwSelectedBkColor;
 		m_dwBorderColor = pInfo->dwSelectedBdColor;
+		uState = UISTATE_SELECTED;
 	}
 	
 	// support item hover state.
@@ -110,6 +129,7 @@ bool UICollectionViewItem::DoPaint(HDC hDC, const RECT& rcPaint, CControlUI *pSt
 		m_dwBackColor = pInfo->dwHotBkColor;
 		m_dwBackColor2 = pInfo->dwHotBkColor;
 		m_dwBorderColor = pInfo->dwHotBdColor;
+		uState = UISTATE_HOT;
 	}
 
 	// support default state.
@@ -119,38 +139,107 @@ bool UICollectionViewItem::DoPaint(HDC hDC, const RECT& rcPaint, CControlUI *pSt
 		m_dwBorderColor = pInfo->dwBdColor;
 	}	
 
-	return CContainerUI::DoPaint(hDC, rcPaint, nullptr);
+	// blit the cached pixels if nothing changed since they were rendered.
+	SIZE szItem = { m_rcItem.right - m_rcItem.left, m_rcItem.bottom - m_rcItem.top };
+	if (m_bRasterStale) ReleaseRaster();
+	if (m_hRaster && m_nRasterIndex == m_nIndex && m_uRasterState == uState && m_szRaster.cx == szItem.cx && m_szRaster.cy == szItem.cy) {
+		HDC hMemDC = ::CreateCompatibleDC(hDC);
+		HBITMAP hOldBitmap = (HBITMAP)::SelectObject(hMemDC, m_hRaster);
+		::BitBlt(hDC, m_rcPaint.left, m_rcPaint.top, m_rcPaint.right - m_rcPaint.left, m_rcPaint.bottom - m_rcPaint.top,
+			hMemDC, m_rcPaint.left - m_rcItem.left, m_rcPaint.top - m_rcItem.top, SRCCOPY);
+		::SelectObject(hMemDC, hOldBitmap);
+		::DeleteDC(hMemDC);
+		return true;
+	}
+
+	// a descendant invalidating while painting leaves the raster stale, it is rendered again next time.
+	m_bRasterStale = false;
+	bool bResult = CContainerUI::DoPaint(hDC, rcPaint, nullptr);
+	if (m_bRasterize) Rasterize(hDC, rcPaint, uState);
+	return bResult;
+}
+
+// Copy the rendered pixels into the raster if the whole item was painted.
+void UICollectionViewItem::Rasterize(HDC hDC, const RECT &rcPaint, UINT uState)
+{
+	// pixels can only be read back from a memory DC, and only where they are painted in this frame.
+	RECT rcClip = { 0 };
+	RECT rcTemp = { 0 };
+	if (::GetObjectType(hDC) != OBJ_MEMDC || ::GetClipBox(hDC, &rcClip) != SIMPLEREGION) return;
+	if (!::IntersectRect(&rcTemp, &rcClip, &rcPaint) || !::IntersectRect(&rcTemp, &rcTemp, &m_rcItem) || !::EqualRect(&rcTemp, &m_rcItem)) return;
+
+	SIZE szItem = { m_rcItem.right - m_rcItem.left, m_rcItem.bottom - m_rcItem.top };
+	if (m_hRaster && (m_szRaster.cx != szItem.cx || m_szRaster.cy != szItem.cy)) ReleaseRaster();
+	if (!m_hRaster) m_hRaster = ::CreateCompatibleBitmap(hDC, szItem.cx, szItem.cy);
+	if (!m_hRaster) return;
+
+	HDC hMemDC = ::CreateCompatibleDC(hDC);
+	HBITMAP hOldBitmap = (HBITMAP)::SelectObject(hMemDC, m_hRaster);
+	::BitBlt(hMemDC, 0, 0, szItem.cx, szItem.cy, hDC, m_rcItem.left, m_rcItem.top, SRCCOPY);
+	::SelectObject(hMemDC, hOldBitmap);
+	::DeleteDC(hMemDC);
+
+	m_nRasterIndex = m_nIndex;
+	m_uRasterState = uState;
+	m_szRaster = szItem;
+}
+
+// Drop the cached pixels.
+void UICollectionViewItem::ReleaseRaster()
+{
+	if (m_hRaster) ::DeleteObject(m_hRaster);
+	m_hRaster = NULL;
+	m_nRasterIndex = -1;
+	m_uRasterState = 0;
+	memset(&m_szRaster, 0, sizeof(SIZE));
+}
+
+// Override to fill the state color once instead of as a gradient of identical colors.
+void UICollectionViewItem::PaintBkColor(HDC hDC)
+{
+	if (m_dwBackColor2 != m_dwBackColor || m_dwBackColor3 != 0) {
+		CContainerUI::PaintBkColor(hDC);
+		return;
+	}
+
+	UICollectionViewSolidFill::Fill(hDC, m_rcPaint, GetAdjustColor(m_dwBackColor));
+}
+
+// Cache the rendered pixels of this item.
+void UICollectionViewItem::SetRasterize(BOOL bRasterize)
+{
+	m_bRasterize = bRasterize;
+	if (!m_bRasterize) ReleaseRaster();
 }
 
 // Override to reduce paint area.
 void UICollectionViewItem::Invalidate()
 {
-	RECT rcPaint = {0};
+	// the cached pixels have the previous state of this item.
+	ReleaseRaster();
 
 	if (m_pContentView) {
-		// crop paint area with content view's client rect.
-		if (!::IntersectRect(&rcPaint, &m_rcItem, &m_pContentView->m_rcScrollable)) 
-			return;
-
-		// crop paint area with all parents' client area.
-		CControlUI *pParent = m_pContentView;
-		RECT rcTemp;
-		RECT rcParent;
-		while (pParent = pParent->GetParent()) {
-			rcTemp = rcPaint;
-			rcParent = pParent->GetPos();
-			if (!::IntersectRect(&rcPaint, &rcTemp, &rcParent)) 
-				return;
-		}
+		// the cached tiles have the previous state of this item.
+		m_pContentView->InvalidateTiles(m_rcItem);
 
-		if (m_pManager)
-			m_pManager->Invalidate(rcPaint);
+		// merged with other items' invalidations, cropped with the content view's cached clip rect.
+		m_pContentView->AddDirtyRect(m_rcItem);
 		return;
 	}
 
 	CContainerUI::Invalidate();
 }
 
+// Override to notice descendants invalidating, `CControlUI::Invalidate()` is not virtual but walks up the parents.
+CControlUI* UICollectionViewItem::GetParent() const
+{
+	// a descendant invalidating clips its dirty rect by the parents' positions, the cached pixels and tiles of this
+	// item may have its previous content then. other callers only cost a repaint.
+	m_bRasterStale = true;
+	if (m_pContentView) m_pContentView->InvalidateTiles(m_nIndex);
+	return CContainerUI::GetParent();
+}
+
 // Override to disable those unsupported attributes.
 void UICollectionViewItem::SetAttribute(LPCTSTR pstrName, LPCTSTR pstrValue)
 {
@@ -168,6 +257,11 @@ void UICollectionViewItem::SetAttribute(LPCTSTR pstrName, LPCTSTR pstrValue)
 		_tcscmp(pstrName, _T("float")) == 0
 		) return;
 
+	if (_tcscmp(pstrName, _T("rasterize")) == 0) {
+		SetRasterize(_tcscmp(pstrValue, _T("true")) == 0);
+		return;
+	}
+
 	CContainerUI::SetAttribute(pstrName, pstrValue);
 }
 
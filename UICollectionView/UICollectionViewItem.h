@@ -16,6 +16,20 @@ namespace DuiLib
 static const LPCTSTR UICollectionViewItemCaption		= (L"itemcaption");
 static const LPCTSTR UICollectionViewItemPreview		= (L"itempreview");
 
+// Counters of item invalidations.
+struct UICollectionViewDirtyRectStats
+{
+	UINT64 nRaw; // rects invalidated by items.
+	UINT64 nMerged; // rects invalidated on screen after merging.
+};
+
+// Counters of items scrolled into view.
+struct UICollectionViewReuseStats
+{
+	UINT64 nHits; // items handed back still bound to their index, without being filled again.
+	UINT64 nMisses; // items filled via delegate.
+};
+
 // Define UI attributes for UICollectionViewItem view.
 struct UICollectionViewItemAttributes
 {
@@ -33,6 +47,9 @@ struct UICollectionViewItemAttributes
 	DWORD dwHotBkColor;				// 0x66B8D6FB
 	DWORD dwSelectedBkColor;		// 0x6684ACDD
 	DWORD dwDisabledBkColor;		// 0xFFFFFFFF
+
+	// item skeleton
+	DWORD dwSkeletonColor;			// 0xFFF0F0F0
 };
 
 // Default UI attributes for UICollectionViewItem view.
@@ -47,6 +64,7 @@ struct UICollectionViewItemDefaultAttributes : public UICollectionViewItemAttrib
 		dwSelectedBdColor = 0xFF84ACDD;
 		dwHotBkColor = 0x66B8D6FB;
 		dwHotBdColor = 0xFFB8D6FB;
+		dwSkeletonColor = 0xFFF0F0F0;
 	}
 };
 
@@ -61,6 +79,9 @@ public:
 	// Constructor.
 	UICollectionViewItem();
 
+	// Destructor.
+	~UICollectionViewItem();
+
 	// UIControl class.
 	LPCTSTR GetClass() const { return L"UICollectionViewItem"; }
 
@@ -85,6 +106,19 @@ public:
 	// Override to reduce paint area.
 	void Invalidate(); 
 
+	// Override to notice descendants invalidating, `CControlUI::Invalidate()` is not virtual but walks up the parents.
+	CControlUI* GetParent() const;
+
+	// Override to fill the state color once instead of as a gradient of identical colors.
+	void PaintBkColor(HDC hDC);
+
+	// Return TRUE if the rendered pixels of this item are cached.
+	BOOL IsRasterize() const { return m_bRasterize; }
+
+	// Cache the rendered pixels of this item and reuse them until the item is re-bound, changes its visual state
+	// or size, or it or a descendant invalidates. It pays off for complex item trees, e.g. with text and rounded borders.
+	void SetRasterize(BOOL bRasterize);
+
 protected:
 
 	// Get the related collection content view.
@@ -102,10 +136,23 @@ protected:
 	// Override to disable those unsupported attributes.
 	void SetAttribute(LPCTSTR pstrName, LPCTSTR pstrValue);
 
+	// Copy the rendered pixels into the raster if the whole item was painted.
+	void Rasterize(HDC hDC, const RECT &rcPaint, UINT uState);
+
+	// Drop the cached pixels.
+	void ReleaseRaster();
+
 private:
 
 	int  m_nIndex; // item index within collection view.
+	UINT64 m_uVersion; // data version the item was filled with, zero if unknown.
 	UINT m_uMouseState; // mouse state flags.
+	BOOL m_bRasterize; // cache rendered pixels.
+	HBITMAP m_hRaster; // rendered pixels.
+	int m_nRasterIndex; // index the raster was rendered for.
+	UINT m_uRasterState; // visual state the raster was rendered for.
+	SIZE m_szRaster; // size the raster was rendered for.
+	mutable bool m_bRasterStale; // a descendant invalidated since the raster was rendered.
 
 private:
 
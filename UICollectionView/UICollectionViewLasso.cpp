@@ -8,6 +8,7 @@
 #include "stdafx.h"
 #include "UICollectionViewLasso.h"
 #include "UICollectionViewContentView.h"
+#include "UICollectionViewSolidFill.h"
 
 namespace DuiLib
 {
@@ -45,16 +46,13 @@ void UICollectionViewLasso::SetMouseMovePos(POINT ptMove)
 	POINT pt1 = ptMove;
 	POINT pt2 = {m_ptDown.x - szOffset.cx, m_ptDown.y - szOffset.cy};
 	m_ptMove = ptMove;
-	m_rcItem.left = min(pt1.x, pt2.x);
-	m_rcItem.top = min(pt1.y, pt2.y);
-	m_rcItem.right = max(pt1.x, pt2.x);
-	m_rcItem.bottom = max(pt1.y, pt2.y);
+	RECT rcLasso = { min(pt1.x, pt2.x), min(pt1.y, pt2.y), max(pt1.x, pt2.x), max(pt1.y, pt2.y) };
 
-	// update the selection area.
-	SetPos(m_rcItem);
+	// update the selection area, the union of previous and current area is repainted.
+	SetPos(rcLasso);
 	
-	// update the background.
-	m_pContentView->NeedUpdate();
+	// update selections, only items whose selection state changed are repainted.
+	m_pContentView->NeedLayout();
 }
 
 // Override to customize painting.
@@ -74,8 +72,8 @@ bool UICollectionViewLasso::DoPaint(HDC hDC, const RECT &rcPaint, CControlUI *pS
 	// is because the default implementation will always paint into the whole
 	// client area, while we only want to paint the intersect rect.
 	
-	// fill the intersect rect.
-	CRenderEngine::DrawGradient(hDC, m_rcPaint, GetAdjustColor(m_dwBackColor), GetAdjustColor(m_dwBackColor2), true, 16);
+	// fill the intersect rect, the lasso color is flat.
+	UICollectionViewSolidFill::Fill(hDC, m_rcPaint, GetAdjustColor(m_dwBackColor));
 
 	// always draw left & right border.
 	RECT rcBorder;
@@ -0,0 +1,207 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewLayout.h"
+
+namespace DuiLib
+{
+
+// Constructor.
+UICollectionViewLayout::UICollectionViewLayout()
+	:m_nCount(0), m_nColumns(0), m_nRows(0), m_nPaddingFix(0)
+{
+	UICollectionViewSize szZero = { 0, 0 };
+	m_szItem = m_szItemPadding = m_szContent = szZero;
+}
+
+// Lay out items in a view.
+bool UICollectionViewLayout::Update(int nViewWidth, int nViewHeight, int nScrollBarWidth)
+{
+	bool bScroll = false;
+	Compute(nViewWidth);
+
+	// re-calculate, if vertical scroll is required
+	if (m_szContent.cy > nViewHeight) {
+		Compute(nViewWidth - nScrollBarWidth);
+		bScroll = true;
+	}
+
+	// put items averagely on the X axis, an extra padding fix is required.
+	m_nPaddingFix = (m_szContent.cx - (m_nColumns * (m_szItem.cx + m_szItemPadding.cx) - m_szItemPadding.cx)) / \
+		((m_nColumns - 1) > 0 ? (m_nColumns - 1) : 2);
+
+	return bScroll;
+}
+
+// Calculate rows, columns and the content size for a view width.
+void UICollectionViewLayout::Compute(int nViewWidth)
+{
+	// calculate total rows and columns based on data source, support item paddings
+	int nColumnWidth = m_szItem.cx + m_szItemPadding.cx;
+	m_nColumns = nColumnWidth > 0 ? ((nViewWidth + m_szItemPadding.cx) / nColumnWidth) : 1;
+	if (m_nColumns <= 0) m_nColumns = 1;
+	m_nRows = (m_nCount % m_nColumns) ? (m_nCount / m_nColumns + 1) : (m_nCount / m_nColumns);
+
+	// calculate the scrollable content size
+	m_szContent.cx = nViewWidth;
+	m_szContent.cy = m_nRows * (m_szItem.cy + m_szItemPadding.cy) - m_szItemPadding.cy;
+}
+
+// Calculate item position (zero based, row, column).
+UICollectionViewRect UICollectionViewLayout::GetItemRect(int nRow, int nColumn) const
+{
+	// code `(m_nColumns > 1)` is used to special handle single column.
+	int nLeft = (m_nColumns > 1) ? (nColumn * (m_szItem.cx + m_szItemPadding.cx + m_nPaddingFix)) : m_nPaddingFix;
+	int nTop = nRow * (m_szItem.cy + m_szItemPadding.cy);
+	UICollectionViewRect rcCell = { nLeft, nTop, nLeft + m_szItem.cx, nTop + m_szItem.cy };
+	return rcCell;
+}
+
+// Calculate item position by its index.
+UICollectionViewRect UICollectionViewLayout::GetItemRect(int nIndex) const
+{
+	if (m_nColumns <= 0) {
+		UICollectionViewRect rcEmpty = { 0, 0, 0, 0 };
+		return rcEmpty;
+	}
+	return GetItemRect(nIndex / m_nColumns, nIndex % m_nColumns);
+}
+
+// Get the rows and columns of cells intersecting a rect.
+bool UICollectionViewLayout::GetItemRange(const UICollectionViewRect &rc, UICollectionViewRect &rcRange) const
+{
+	if (m_nColumns <= 0 || m_nRows <= 0 || rc.left >= rc.right || rc.top >= rc.bottom) return false;
+
+	// rows, a cell spans its item and the padding below it.
+	int nRowHeight = GetRowHeight();
+	if (nRowHeight <= 0) return false;
+	rcRange.top = (rc.top > 0 ? rc.top : 0) / nRowHeight;
+	rcRange.bottom = (rc.bottom - 1 > 0 ? rc.bottom - 1 : 0) / nRowHeight;
+	if (rcRange.bottom > m_nRows - 1) rcRange.bottom = m_nRows - 1;
+
+	// columns, a cell spans its item and the padding on its right.
+	int nColumnWidth = m_szItem.cx + m_szItemPadding.cx + m_nPaddingFix;
+	if (m_nColumns == 1 || nColumnWidth <= 0) {
+		rcRange.left = rcRange.right = 0;
+	} else {
+		rcRange.left = (rc.left > 0 ? rc.left : 0) / nColumnWidth;
+		rcRange.right = (rc.right - 1 > 0 ? rc.right - 1 : 0) / nColumnWidth;
+		if (rcRange.right > m_nColumns - 1) rcRange.right = m_nColumns - 1;
+	}
+
+	return rcRange.top <= rcRange.bottom && rcRange.left <= rcRange.right;
+}
+
+// Get the index range of items visible in a view scrolled to the position.
+bool UICollectionViewLayout::GetVisibleRange(int nScrollPos, int nViewHeight, int &nFirst, int &nLast) const
+{
+	int nRowHeight = GetRowHeight();
+	if (m_nCount <= 0 || m_nColumns <= 0 || nRowHeight <= 0) return false;
+
+	// calculate index range of visible items by dividing scroll pos with item height
+	nFirst = (nScrollPos / nRowHeight) * m_nColumns;
+	if (nFirst < 0) nFirst = 0;
+	nLast = ((nScrollPos + nViewHeight) / nRowHeight + 1) * m_nColumns - 1;
+	if (nLast > m_nCount - 1) nLast = (m_nCount - 1);
+	return nFirst <= nLast;
+}
+
+// Get the rows and columns selected by a lasso.
+UICollectionViewRect UICollectionViewLayout::GetLassoRange(const UICollectionViewRect &rcLasso) const
+{
+	UICollectionViewRect rcIdx = { -1, -1, -1, -1 };
+	int nRowHeight = GetRowHeight();
+	if (nRowHeight <= 0) return rcIdx;
+
+	// calculate selection index range in X axis.
+	for (int nColumn = 0; nColumn < m_nColumns; nColumn ++) {
+		UICollectionViewRect rcCell = GetItemRect(0, nColumn);
+
+		// nearest cell, its right border is larger than rcLasso.left.
+		if (rcCell.right > rcLasso.left && rcIdx.left < 0)
+			rcIdx.left = nColumn; /* first matched */
+
+		// nearest cell, its left border is smaller than rcLasso.right.
+		if (rcCell.left < rcLasso.right)
+			rcIdx.right = nColumn; /* last matched */
+	}
+
+	// calculate selection index range in Y axis.
+	if (rcLasso.top > 0) {
+		rcIdx.top = rcLasso.top / nRowHeight;
+		if (rcLasso.top % nRowHeight > m_szItem.cy)
+			rcIdx.top ++;
+	} else {
+		rcIdx.top = 0;
+	}
+	if (rcLasso.bottom > 0) {
+		rcIdx.bottom = rcLasso.bottom / nRowHeight;
+	}
+
+	return rcIdx;
+}
+
+// Get the index reached by a keyboard move from an index.
+int UICollectionViewLayout::GetMovedIndex(int nIndex, UICollectionViewMove move, int nViewHeight) const
+{
+	int nRowHeight = GetRowHeight();
+	if (m_nCount <= 0 || m_nColumns <= 0 || nRowHeight <= 0) return -1;
+	if (nIndex < 0 || nIndex >= m_nCount) return 0;
+
+	// a page keeps at least one row, moving up or down stays in the column while there is a row.
+	int nPage = (nViewHeight / nRowHeight > 1 ? nViewHeight / nRowHeight : 1) * m_nColumns;
+	switch (move) {
+	case UICollectionViewMoveLeft: nIndex --; break;
+	case UICollectionViewMoveRight: nIndex ++; break;
+	case UICollectionViewMoveUp: if (nIndex >= m_nColumns) nIndex -= m_nColumns; break;
+	case UICollectionViewMoveDown: if (nIndex / m_nColumns < m_nRows - 1) nIndex += m_nColumns; break;
+	case UICollectionViewMovePageUp: nIndex = nIndex >= nPage ? nIndex - nPage : nIndex % m_nColumns; break;
+	case UICollectionViewMovePageDown: nIndex += nPage; break;
+	case UICollectionViewMoveHome: nIndex = 0; break;
+	case UICollectionViewMoveEnd: nIndex = m_nCount - 1; break;
+	}
+
+	// the last row may be partial.
+	if (nIndex < 0) nIndex = 0;
+	if (nIndex > m_nCount - 1) nIndex = m_nCount - 1;
+	return nIndex;
+}
+
+// Anchor the first item visible in a view scrolled to the position.
+UICollectionViewAnchor UICollectionViewLayout::GetAnchor(int nScrollPos, int nViewHeight) const
+{
+	UICollectionViewAnchor anchor = { -1, 0 };
+	int nFirst = 0, nLast = -1;
+	if (!GetVisibleRange(nScrollPos, nViewHeight, nFirst, nLast)) return anchor;
+
+	// the offset is usually negative, the first visible row is partially scrolled out.
+	anchor.nIndex = nFirst;
+	anchor.nOffset = GetItemRect(nFirst).top - nScrollPos;
+	return anchor;
+}
+
+// Get the scroll position which keeps an anchor item at its offset.
+int UICollectionViewLayout::GetAnchoredScrollPos(const UICollectionViewAnchor &anchor) const
+{
+	if (anchor.nIndex < 0 || m_nCount <= 0 || m_nColumns <= 0) return 0;
+	int nScrollPos = GetItemRect(anchor.nIndex < m_nCount ? anchor.nIndex : m_nCount - 1).top - anchor.nOffset;
+	return nScrollPos > 0 ? nScrollPos : 0;
+}
+
+// Get the scroll position which shows a whole item with the least scrolling.
+int UICollectionViewLayout::GetScrollPosToShow(int nIndex, int nScrollPos, int nViewHeight) const
+{
+	if (nIndex < 0 || nIndex >= m_nCount || m_nColumns <= 0) return nScrollPos;
+
+	// an item taller than the view shows its top.
+	UICollectionViewRect rcItem = GetItemRect(nIndex);
+	if (rcItem.bottom > nScrollPos + nViewHeight) nScrollPos = rcItem.bottom - nViewHeight;
+	if (rcItem.top < nScrollPos) nScrollPos = rcItem.top;
+	return nScrollPos;
+}
+
+}
@@ -0,0 +1,130 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UICollectionViewGeometry.h"
+
+namespace DuiLib
+{
+
+// Keyboard moves of the focused item.
+enum UICollectionViewMove
+{
+	UICollectionViewMoveLeft,
+	UICollectionViewMoveRight,
+	UICollectionViewMoveUp,
+	UICollectionViewMoveDown,
+	UICollectionViewMovePageUp,
+	UICollectionViewMovePageDown,
+	UICollectionViewMoveHome,
+	UICollectionViewMoveEnd
+};
+
+// An item kept at its offset from the top of the viewport while items are inserted, removed or reflowed.
+struct UICollectionViewAnchor
+{
+	int nIndex; // anchor item, -1 if there is none.
+	int nOffset; // offset of the item from the top of the viewport, negative if it is partially scrolled out.
+};
+
+// The flow layout of the collection view: items of the same size are put into rows, as many columns as
+// fit into the view width, spread averagely on the X axis. Rects are in content coordinates, whose origin
+// is the top left corner of the first item, i.e. they don't move while scrolling. It has no knowledge of
+// controls or windows, the content view feeds it the view size and maps its rects onto the screen.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewLayout
+{
+public:
+
+	// Constructor.
+	UICollectionViewLayout();
+
+	// Get the size of each item.
+	UICollectionViewSize GetItemSize() const { return m_szItem; }
+
+	// Set the size of each item, the layout is updated by `Update()`.
+	void SetItemSize(UICollectionViewSize szItem) { m_szItem = szItem; }
+
+	// Get the padding between items.
+	UICollectionViewSize GetItemPadding() const { return m_szItemPadding; }
+
+	// Set the padding between items, the layout is updated by `Update()`.
+	void SetItemPadding(UICollectionViewSize szPadding) { m_szItemPadding = szPadding; }
+
+	// Get the number of items.
+	int GetCount() const { return m_nCount; }
+
+	// Set the number of items, the layout is updated by `Update()`.
+	void SetCount(int nCount) { m_nCount = nCount > 0 ? nCount : 0; }
+
+	// Lay out items in a view, the width of a vertical scroll bar is reserved if the content is taller than the view.
+	// Return true if the vertical scroll bar is required.
+	bool Update(int nViewWidth, int nViewHeight, int nScrollBarWidth);
+
+	// Get the number of columns.
+	int GetColumns() const { return m_nColumns; }
+
+	// Get the number of rows.
+	int GetRows() const { return m_nRows; }
+
+	// Get the size of the whole content.
+	UICollectionViewSize GetContentSize() const { return m_szContent; }
+
+	// Get the extra padding to put items averagely on the X axis.
+	int GetPaddingFix() const { return m_nPaddingFix; }
+
+	// Get the height of a row including the padding below it.
+	int GetRowHeight() const { return m_szItem.cy + m_szItemPadding.cy; }
+
+	// Calculate item position (zero based, row, column).
+	UICollectionViewRect GetItemRect(int nRow, int nColumn) const;
+
+	// Calculate item position by its index.
+	UICollectionViewRect GetItemRect(int nIndex) const;
+
+	// Get the rows and columns of cells intersecting a rect, `rcRange` holds the first / last column in left / right,
+	// and the first / last row in top / bottom. Return false if no cell intersects.
+	bool GetItemRange(const UICollectionViewRect &rc, UICollectionViewRect &rcRange) const;
+
+	// Get the index range of items visible in a view scrolled to the position. Return false if there is no item.
+	bool GetVisibleRange(int nScrollPos, int nViewHeight, int &nFirst, int &nLast) const;
+
+	// Get the rows and columns selected by a lasso, in the same form as `GetItemRange()`. A column is selected once the
+	// lasso touches it, a row once the lasso passes the top of its item. Members are -1 if nothing is selected.
+	UICollectionViewRect GetLassoRange(const UICollectionViewRect &rcLasso) const;
+
+	// Get the index reached by a keyboard move from an index, a page is as many rows as fit into the view. Moves stop at
+	// the first and last item, and any move from -1 reaches the first item. Return -1 if there is no item.
+	int GetMovedIndex(int nIndex, UICollectionViewMove move, int nViewHeight) const;
+
+	// Anchor the first item visible in a view scrolled to the position, its index is -1 if there is no item.
+	UICollectionViewAnchor GetAnchor(int nScrollPos, int nViewHeight) const;
+
+	// Get the scroll position which keeps an anchor item at its offset, e.g. after items were inserted above it or the
+	// columns changed. An anchor beyond the last item anchors the last item.
+	int GetAnchoredScrollPos(const UICollectionViewAnchor &anchor) const;
+
+	// Get the scroll position which shows a whole item with the least scrolling from the current one.
+	int GetScrollPosToShow(int nIndex, int nScrollPos, int nViewHeight) const;
+
+private:
+
+	// Calculate rows, columns and the content size for a view width.
+	void Compute(int nViewWidth);
+
+	UICollectionViewSize m_szItem; // size of each item (fixed).
+	UICollectionViewSize m_szItemPadding; // padding between items.
+	int m_nCount; // number of items.
+	int m_nColumns; // virtual columns.
+	int m_nRows; // virtual rows.
+	UICollectionViewSize m_szContent; // size of whole virtual area.
+	int m_nPaddingFix; // extra padding to put items averagely on the X axis.
+};
+
+}
@@ -0,0 +1,188 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewParallelRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+namespace DuiLib
+{
+
+// Constructor.
+UICollectionViewParallelRenderer::UICollectionViewParallelRenderer(int nThreads, int nTileSize)
+	:m_nThreads(1), m_nTileSize(nTileSize > 0 ? nTileSize : 128), m_pCanvas(NULL), m_pLayout(NULL), m_nScrollPos(0),
+	 m_uBackground(0), m_nFirstIndex(0), m_nFrame(0), m_nBusyWorkers(0), m_bStop(false), m_nNextTile(0)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+	SetThreadCount(nThreads);
+}
+
+// Destructor, the worker threads are joined.
+UICollectionViewParallelRenderer::~UICollectionViewParallelRenderer()
+{
+	StopWorkers();
+}
+
+// Set the number of threads rasterizing, zero uses one per core.
+void UICollectionViewParallelRenderer::SetThreadCount(int nThreads)
+{
+	if (nThreads <= 0) nThreads = (int)std::thread::hardware_concurrency();
+	if (nThreads <= 0) nThreads = 1;
+	if (nThreads == m_nThreads && (int)m_Workers.size() == m_nThreads - 1) return;
+
+	StopWorkers();
+	m_nThreads = nThreads;
+	StartWorkers();
+}
+
+// Render items visible at the scroll position.
+void UICollectionViewParallelRenderer::Render(UICollectionViewCanvas &canvas, const UICollectionViewLayout &layout, int nScrollPos, const DescribeItem &describe, uint32_t uBackground)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	// describe visible items on the calling thread, workers only read the descriptions.
+	m_pCanvas = &canvas;
+	m_pLayout = &layout;
+	m_nScrollPos = nScrollPos;
+	m_uBackground = uBackground;
+	m_nFirstIndex = 0;
+	m_Items.clear();
+	int nLastIndex = -1;
+	if (layout.GetVisibleRange(nScrollPos, canvas.GetHeight(), m_nFirstIndex, nLastIndex)) {
+		m_Items.resize(nLastIndex - m_nFirstIndex + 1);
+		for (size_t i = 0; i < m_Items.size(); i ++) {
+			memset(&m_Items[i], 0, sizeof(UICollectionViewRenderItem));
+			if (describe) describe(m_nFirstIndex + (int)i, m_Items[i]);
+		}
+	}
+
+	// split the viewport into tiles.
+	m_Tiles.clear();
+	for (int y = 0; y < canvas.GetHeight(); y += m_nTileSize) {
+		for (int x = 0; x < canvas.GetWidth(); x += m_nTileSize) {
+			UICollectionViewRect rcTile = { x, y, std::min(x + m_nTileSize, canvas.GetWidth()), std::min(y + m_nTileSize, canvas.GetHeight()) };
+			m_Tiles.push_back(rcTile);
+		}
+	}
+	m_nNextTile = 0;
+
+	// wake up the workers and rasterize along with them, the frame must not change until all of them are idle again.
+	if (!m_Workers.empty() && m_Tiles.size() > 1) {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_nFrame ++;
+			m_nBusyWorkers = (int)m_Workers.size();
+		}
+		m_FrameReady.notify_all();
+		RasterizeTiles();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_FrameDone.wait(lock, [this] { return m_nBusyWorkers == 0; });
+	} else {
+		RasterizeTiles();
+	}
+
+	m_Stats.nItems = (int)m_Items.size();
+	m_Stats.nTiles = (int)m_Tiles.size();
+	m_Stats.nThreads = m_Tiles.size() > 1 ? m_nThreads : 1;
+	m_Stats.fMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+
+	m_pCanvas = NULL;
+	m_pLayout = NULL;
+}
+
+// Start the worker threads.
+void UICollectionViewParallelRenderer::StartWorkers()
+{
+	m_bStop = false;
+
+	// the calling thread rasterizes too, a worker only waits for frames after the current one.
+	for (int i = 1; i < m_nThreads; i ++) {
+		unsigned nFrame = m_nFrame;
+		m_Workers.push_back(std::thread([this, nFrame] { WorkerProc(nFrame); }));
+	}
+}
+
+// Stop and join the worker threads.
+void UICollectionViewParallelRenderer::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bStop = true;
+	}
+	m_FrameReady.notify_all();
+
+	for (size_t i = 0; i < m_Workers.size(); i ++) {
+		m_Workers[i].join();
+	}
+	m_Workers.clear();
+}
+
+// Wait for frames after `nFrame` and rasterize their tiles.
+void UICollectionViewParallelRenderer::WorkerProc(unsigned nFrame)
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_FrameReady.wait(lock, [this, nFrame] { return m_bStop || m_nFrame != nFrame; });
+			if (m_bStop) return;
+			nFrame = m_nFrame;
+		}
+
+		RasterizeTiles();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (-- m_nBusyWorkers == 0) m_FrameDone.notify_one();
+	}
+}
+
+// Rasterize tiles of the current frame until none is left.
+void UICollectionViewParallelRenderer::RasterizeTiles()
+{
+	for (int i = m_nNextTile ++; i < (int)m_Tiles.size(); i = m_nNextTile ++) {
+		RasterizeTile(m_Tiles[i]);
+	}
+}
+
+// Rasterize a tile of the current frame.
+void UICollectionViewParallelRenderer::RasterizeTile(const UICollectionViewRect &rcTile)
+{
+	// each tile paints through its own canvas over the shared pixels, clipped to the tile.
+	UICollectionViewCanvas canvas(m_pCanvas->GetBits(), m_pCanvas->GetWidth(), m_pCanvas->GetHeight(), m_pCanvas->GetStride());
+	canvas.SetClip(rcTile);
+	canvas.Clear(m_uBackground);
+
+	// only visit cells intersecting the tile, the layout works in content coordinates.
+	UICollectionViewRect rcContent = { rcTile.left, rcTile.top + m_nScrollPos, rcTile.right, rcTile.bottom + m_nScrollPos };
+	UICollectionViewRect rcRange = {};
+	if (!m_pLayout->GetItemRange(rcContent, rcRange)) return;
+
+	int nColumns = m_pLayout->GetColumns();
+	for (int nRow = rcRange.top; nRow <= rcRange.bottom; nRow ++) {
+		for (int nColumn = rcRange.left; nColumn <= rcRange.right; nColumn ++) {
+			int nIndex = nRow * nColumns + nColumn;
+			if (nIndex < m_nFirstIndex || nIndex >= m_nFirstIndex + (int)m_Items.size()) continue;
+
+			const UICollectionViewRenderItem &item = m_Items[nIndex - m_nFirstIndex];
+			UICollectionViewRect rcItem = m_pLayout->GetItemRect(nRow, nColumn);
+			rcItem.top -= m_nScrollPos;
+			rcItem.bottom -= m_nScrollPos;
+
+			// background, preview and border, in the order the item controls paint them.
+			canvas.FillRect(rcItem, item.dwBkColor);
+			if (item.pPreview) {
+				UICollectionViewRect rcPreview = { rcItem.left + item.rcPreview.left, rcItem.top + item.rcPreview.top,
+					rcItem.left + item.rcPreview.right, rcItem.top + item.rcPreview.bottom };
+				canvas.DrawImage(rcPreview, item.pPreview, item.nPreviewWidth, item.nPreviewHeight, item.nPreviewStride);
+			}
+			canvas.DrawBorder(rcItem, item.nBorderWidth, item.dwBdColor);
+		}
+	}
+}
+
+}
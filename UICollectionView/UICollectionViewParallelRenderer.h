@@ -0,0 +1,125 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UICollectionViewCanvas.h"
+#include "UICollectionViewLayout.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DuiLib
+{
+
+// What to paint for an item, filled on the calling thread before tiles are rasterized.
+struct UICollectionViewRenderItem
+{
+	uint32_t dwBkColor; // ARGB background.
+	uint32_t dwBdColor; // ARGB border.
+	int nBorderWidth; // border width inside the item.
+	const uint32_t *pPreview; // premultiplied BGRA preview, optional, must stay valid while rendering.
+	int nPreviewWidth; // preview width in pixels.
+	int nPreviewHeight; // preview height in pixels.
+	int nPreviewStride; // preview stride in pixels.
+	UICollectionViewRect rcPreview; // preview position relative to the item.
+};
+
+// Counters of the last frame.
+struct UICollectionViewRenderStats
+{
+	int nItems; // items described.
+	int nTiles; // tiles rasterized.
+	int nThreads; // threads rasterizing, including the calling one.
+	double fMilliseconds; // time to render the frame.
+};
+
+// Render the items of a flow layout into a canvas, split into tiles which are rasterized in parallel by a
+// pool of worker threads and the calling thread. Tiles don't overlap, so they are written into the shared
+// canvas without locking; the canvas can wrap the bits of a DIB section to be composited on the UI thread.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewParallelRenderer
+{
+public:
+
+	// Fill the paint description of the item at an index.
+	typedef std::function<void(int nIndex, UICollectionViewRenderItem &item)> DescribeItem;
+
+	// Constructor, zero threads uses one per core.
+	UICollectionViewParallelRenderer(int nThreads = 0, int nTileSize = 128);
+
+	// Destructor, the worker threads are joined.
+	~UICollectionViewParallelRenderer();
+
+	// Get the number of threads rasterizing, including the calling one.
+	int GetThreadCount() const { return m_nThreads; }
+
+	// Set the number of threads rasterizing, zero uses one per core.
+	void SetThreadCount(int nThreads);
+
+	// Get the edge length of a tile.
+	int GetTileSize() const { return m_nTileSize; }
+
+	// Set the edge length of a tile.
+	void SetTileSize(int nTileSize) { if (nTileSize > 0) m_nTileSize = nTileSize; }
+
+	// Render items visible at the scroll position, the canvas is the viewport. Its pixels are replaced by the premultiplied
+	// background color before items are painted.
+	void Render(UICollectionViewCanvas &canvas, const UICollectionViewLayout &layout, int nScrollPos, const DescribeItem &describe, uint32_t uBackground = 0);
+
+	// Get counters of the last frame.
+	UICollectionViewRenderStats GetStats() const { return m_Stats; }
+
+private:
+
+	// Not copyable, it owns threads.
+	UICollectionViewParallelRenderer(const UICollectionViewParallelRenderer &);
+	UICollectionViewParallelRenderer& operator=(const UICollectionViewParallelRenderer &);
+
+	// Start the worker threads.
+	void StartWorkers();
+
+	// Stop and join the worker threads.
+	void StopWorkers();
+
+	// Wait for frames after `nFrame` and rasterize their tiles.
+	void WorkerProc(unsigned nFrame);
+
+	// Rasterize tiles of the current frame until none is left.
+	void RasterizeTiles();
+
+	// Rasterize a tile of the current frame.
+	void RasterizeTile(const UICollectionViewRect &rcTile);
+
+	int m_nThreads; // threads rasterizing, including the calling one.
+	int m_nTileSize; // edge length of a tile.
+	UICollectionViewRenderStats m_Stats; // counters of the last frame.
+
+	// the current frame, written by the calling thread before workers are woken up.
+	UICollectionViewCanvas *m_pCanvas; // target of the frame.
+	const UICollectionViewLayout *m_pLayout; // layout of the frame.
+	int m_nScrollPos; // scroll position of the frame.
+	uint32_t m_uBackground; // background of the frame.
+	int m_nFirstIndex; // index of the first described item.
+	std::vector<UICollectionViewRenderItem> m_Items; // described items from the first index.
+	std::vector<UICollectionViewRect> m_Tiles; // tiles of the frame.
+
+	std::vector<std::thread> m_Workers; // worker threads.
+	std::mutex m_Mutex; // guards the frame hand-off.
+	std::condition_variable m_FrameReady; // a frame is ready or workers are stopping.
+	std::condition_variable m_FrameDone; // workers finished the frame.
+	unsigned m_nFrame; // frame number, workers wake up when it changes.
+	int m_nBusyWorkers; // workers rasterizing the current frame.
+	bool m_bStop; // workers are stopping.
+	std::atomic<int> m_nNextTile; // next tile to rasterize.
+};
+
+}
@@ -0,0 +1,102 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "UICollectionViewSelection.h"
+#include <algorithm>
+
+namespace DuiLib
+{
+
+// Select items within a range of rows and columns.
+std::set<int> UICollectionViewSelection::SelectRange(const std::set<int> &sPersisted, const UICollectionViewRect &rcRange, int nColumns, int nCount, bool bToggle)
+{
+	std::set<int> sIndexes;
+	if (bToggle) sIndexes = sPersisted;
+	if (rcRange.left < 0 || rcRange.right < 0 || rcRange.top < 0 || rcRange.bottom < 0) return sIndexes;
+
+	for (int i = rcRange.left; i <= rcRange.right; i ++) {
+		for (int j = rcRange.top; j <= rcRange.bottom; j ++) {
+			int nIndex = (j * nColumns + i);
+
+			// the range can be used to do reverse selection.
+			if (bToggle && sPersisted.count(nIndex)) {
+				sIndexes.erase(nIndex);
+			} else if (nIndex < nCount) { /* boundary validation */
+				sIndexes.insert(nIndex);
+			}
+		}
+	}
+
+	return sIndexes;
+}
+
+// Select all items.
+std::set<int> UICollectionViewSelection::SelectAll(int nCount)
+{
+	// indexes are ascending, so each one is appended at the end.
+	std::set<int> sIndexes;
+	for (int i = 0; i < nCount; i ++)
+		sIndexes.insert(sIndexes.end(), i);
+	return sIndexes;
+}
+
+// Select the items from one index to another in either order.
+std::set<int> UICollectionViewSelection::SelectSpan(int nFrom, int nTo)
+{
+	std::set<int> sIndexes;
+	if (nFrom > nTo) std::swap(nFrom, nTo);
+	for (int i = (nFrom > 0 ? nFrom : 0); i <= nTo; i ++)
+		sIndexes.insert(sIndexes.end(), i);
+	return sIndexes;
+}
+
+// Drop an index and decrease greater indexes by 1.
+void UICollectionViewSelection::RemoveIndex(std::set<int> &sIndexes, int nIndex)
+{
+	// find all indexes greater than the bound and decrease them by 1.
+	std::set<int> sNewIndexes;
+	for (auto itr = sIndexes.begin(); itr != sIndexes.lower_bound(nIndex); itr ++)
+		sNewIndexes.insert(sNewIndexes.end(), *itr);
+	for (auto itr = sIndexes.upper_bound(nIndex); itr != sIndexes.end(); itr ++)
+		sNewIndexes.insert(sNewIndexes.end(), *itr - 1);
+	sIndexes.swap(sNewIndexes);
+}
+
+// Increase indexes from an index on by 1.
+void UICollectionViewSelection::InsertIndex(std::set<int> &sIndexes, int nIndex)
+{
+	std::set<int> sNewIndexes;
+	for (auto itr = sIndexes.begin(); itr != sIndexes.lower_bound(nIndex); itr ++)
+		sNewIndexes.insert(sNewIndexes.end(), *itr);
+	for (auto itr = sIndexes.lower_bound(nIndex); itr != sIndexes.end(); itr ++)
+		sNewIndexes.insert(sNewIndexes.end(), *itr + 1);
+	sIndexes.swap(sNewIndexes);
+}
+
+// Get the index of an item after items were inserted at the indexes.
+int UICollectionViewSelection::GetIndexAfterInsertion(int nIndex, const std::set<int> &sInserted)
+{
+	// ascending, each insertion at or before the item pushes it down.
+	for (int i : sInserted) {
+		if (i > nIndex) break;
+		nIndex ++;
+	}
+	return nIndex;
+}
+
+// Get the index of an item after items at the indexes were removed.
+int UICollectionViewSelection::GetIndexAfterRemoval(int nIndex, const std::set<int> &sRemoved)
+{
+	int nNewIndex = nIndex;
+	for (int i : sRemoved) {
+		if (i >= nIndex) break;
+		nNewIndex --;
+	}
+	return nNewIndex;
+}
+
+}
@@ -0,0 +1,47 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UICollectionViewGeometry.h"
+#include <set>
+
+namespace DuiLib
+{
+
+// The selection model of the collection view, selections are plain sets of item indexes. Input state such
+// as modifier keys is decided by the caller.
+//
+// This file only depends on the C++ runtime, so it also builds on platforms without DuiLib.
+class UICollectionViewSelection
+{
+public:
+
+	// Select items within a range of rows and columns from `UICollectionViewLayout::GetLassoRange()`. Without `bToggle`
+	// the selection is the items in the range, with it items in the range flip their state in the persisted selection.
+	static std::set<int> SelectRange(const std::set<int> &sPersisted, const UICollectionViewRect &rcRange, int nColumns, int nCount, bool bToggle);
+
+	// Select all items.
+	static std::set<int> SelectAll(int nCount);
+
+	// Select the items from one index to another in either order, e.g. a SHIFT selection from its anchor.
+	static std::set<int> SelectSpan(int nFrom, int nTo);
+
+	// Drop an index and decrease greater indexes by 1, i.e. the item at the index was removed.
+	static void RemoveIndex(std::set<int> &sIndexes, int nIndex);
+
+	// Increase indexes from an index on by 1, i.e. an item was inserted at the index.
+	static void InsertIndex(std::set<int> &sIndexes, int nIndex);
+
+	// Get the index of an item after items were inserted at the indexes, which are numbered after the insertion.
+	static int GetIndexAfterInsertion(int nIndex, const std::set<int> &sInserted);
+
+	// Get the index of an item after items at the indexes were removed, a removed item takes the index of the next one.
+	static int GetIndexAfterRemoval(int nIndex, const std::set<int> &sRemoved);
+};
+
+}
@@ -0,0 +1,93 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewSolidFill.h"
+#include "UICollectionViewCanvas.h"
+#include <vector>
+
+namespace DuiLib
+{
+
+// Fill a rect in logical coordinates of the DC with an ARGB color.
+void UICollectionViewSolidFill::Fill(HDC hDC, const RECT &rc, DWORD dwColor)
+{
+	FillRects(hDC, &rc, 1, dwColor);
+}
+
+// Fill the part of a rect with round corners within the paint rect, in logical coordinates of the DC.
+void UICollectionViewSolidFill::FillRound(HDC hDC, const RECT &rcItem, const RECT &rcPaint, int nRoundX, int nRoundY, DWORD dwColor)
+{
+	RECT rcFill = { 0 };
+	if ((dwColor >> 24) == 0 || !::IntersectRect(&rcFill, &rcItem, &rcPaint)) return;
+
+	// square corners need no region at all.
+	if (nRoundX <= 0 || nRoundY <= 0) {
+		FillRects(hDC, &rcFill, 1, dwColor);
+		return;
+	}
+
+	// the same shape as `CRenderClip::GenerateRoundClip`, but GDI splits it into a few bands of rects which
+	// are filled directly, instead of clipping the fill to a complex region.
+	HRGN hRgn = ::CreateRoundRectRgn(rcItem.left, rcItem.top, rcItem.right + 1, rcItem.bottom + 1, nRoundX, nRoundY);
+	HRGN hRgnPaint = ::CreateRectRgnIndirect(&rcFill);
+	::CombineRgn(hRgn, hRgn, hRgnPaint, RGN_AND);
+	::DeleteObject(hRgnPaint);
+
+	DWORD dwSize = ::GetRegionData(hRgn, 0, NULL);
+	std::vector<BYTE> data(dwSize > 0 ? dwSize : 1);
+	RGNDATA *pData = (RGNDATA *)&data[0];
+	if (dwSize > 0 && ::GetRegionData(hRgn, dwSize, pData) == dwSize) {
+		FillRects(hDC, (const RECT *)pData->Buffer, (int)pData->rdh.nCount, dwColor);
+	}
+	::DeleteObject(hRgn);
+}
+
+// Fill rects in logical coordinates of the DC, directly into the pixels of a DIB section if possible.
+void UICollectionViewSolidFill::FillRects(HDC hDC, const RECT *pRects, int nCount, DWORD dwColor)
+{
+	if ((dwColor >> 24) == 0 || nCount <= 0) return;
+
+	RECT rcClip = { 0 };
+	RECT rcFill = { 0 };
+	int nRegion = ::GetClipBox(hDC, &rcClip);
+	if (nRegion == NULLREGION) return;
+
+	// pixels can only be written directly into a DIB section, and only if the clip is a rect.
+	DIBSECTION ds = { 0 };
+	HBITMAP hBitmap = (HBITMAP)::GetCurrentObject(hDC, OBJ_BITMAP);
+	if (nRegion != SIMPLEREGION || ::GetObjectType(hDC) != OBJ_MEMDC || !hBitmap
+		|| ::GetObject(hBitmap, sizeof(DIBSECTION), &ds) != sizeof(DIBSECTION)
+		|| ds.dsBm.bmBitsPixel != 32 || !ds.dsBm.bmBits) {
+		for (int i = 0; i < nCount; i ++) {
+			if (::IntersectRect(&rcFill, &pRects[i], &rcClip)) CRenderEngine::DrawColor(hDC, rcFill, dwColor);
+		}
+		return;
+	}
+
+	// finish pending GDI drawing before touching the bits, bottom-up DIBs are addressed with a negative stride.
+	::GdiFlush();
+	int nStride = ds.dsBm.bmWidthBytes / sizeof(uint32_t);
+	uint32_t *pBits = (uint32_t *)ds.dsBm.bmBits;
+	if (ds.dsBmih.biHeight > 0) {
+		pBits += (ds.dsBm.bmHeight - 1) * nStride;
+		nStride = -nStride;
+	}
+
+	UICollectionViewCanvas canvas(pBits, ds.dsBm.bmWidth, ds.dsBm.bmHeight, nStride);
+	for (int i = 0; i < nCount; i ++) {
+		if (!::IntersectRect(&rcFill, &pRects[i], &rcClip)) continue;
+
+		// the fill rect is cropped by the clip box, map it to the bitmap, the canvas crops it to the bitmap.
+		POINT pt[2] = { { rcFill.left, rcFill.top }, { rcFill.right, rcFill.bottom } };
+		::LPtoDP(hDC, pt, 2);
+		UICollectionViewCanvas::Rect rcCanvas = { min(pt[0].x, pt[1].x), min(pt[0].y, pt[1].y), max(pt[0].x, pt[1].x), max(pt[0].y, pt[1].y) };
+		canvas.FillRect(rcCanvas, dwColor);
+	}
+}
+
+}
@@ -0,0 +1,37 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+
+namespace DuiLib
+{
+
+// Fill a rect with a solid, possibly translucent, color. Item state backgrounds and the lasso are flat
+// colors, painting them as a 16 step gradient of identical colors alpha blends 16 bands instead of one.
+// When the DC has a 32bpp DIB section selected and a rectangular clip, the pixels are blended in place
+// with premultiplied alpha by the SSE2 loop of `UICollectionViewCanvas`; otherwise the color is drawn
+// once by the render engine. Items with round corners are filled as the few rects GDI splits their
+// round region into, instead of being clipped to the region, so they take the fast path too.
+class UICollectionViewSolidFill
+{
+public:
+
+	// Fill a rect in logical coordinates of the DC with an ARGB color.
+	static void Fill(HDC hDC, const RECT &rc, DWORD dwColor);
+
+	// Fill the part of a rect with round corners within the paint rect, in logical coordinates of the DC.
+	static void FillRound(HDC hDC, const RECT &rcItem, const RECT &rcPaint, int nRoundX, int nRoundY, DWORD dwColor);
+
+protected:
+
+	// Fill rects in logical coordinates of the DC, directly into the pixels of a DIB section if possible.
+	static void FillRects(HDC hDC, const RECT *pRects, int nCount, DWORD dwColor);
+};
+
+}
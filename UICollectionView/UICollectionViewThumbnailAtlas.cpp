@@ -0,0 +1,194 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewThumbnailAtlas.h"
+#include <algorithm>
+
+namespace DuiLib
+{
+
+// Constructor, each page holds `nColumns` x `nRows` slots.
+UICollectionViewThumbnailAtlas::UICollectionViewThumbnailAtlas(SIZE szSlot, int nColumns, int nRows)
+	:m_pState(new State)
+{
+	ASSERT(szSlot.cx > 0 && szSlot.cy > 0 && nColumns > 0 && nRows > 0);
+	m_pState->szSlot = szSlot;
+	m_pState->nColumns = nColumns;
+	m_pState->nRows = nRows;
+	m_pState->nSlotsInUse = 0;
+}
+
+// Destructor, pages in use are kept alive by their thumbnails.
+UICollectionViewThumbnailAtlas::~UICollectionViewThumbnailAtlas()
+{
+}
+
+// Get the size of each slot.
+SIZE UICollectionViewThumbnailAtlas::GetSlotSize() const
+{
+	return m_pState->szSlot;
+}
+
+// Allocate a transparent thumbnail in a free slot, a new page is created if all pages are full.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailAtlas::Allocate()
+{
+	return Allocate(m_pState->szSlot);
+}
+
+// Copy a thumbnail into a free slot, the source must not be larger than the slot.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailAtlas::Pack(const UICollectionViewThumbnail *pSource)
+{
+	if (!pSource || !pSource->GetBits()) return UICollectionViewThumbnailPtr();
+
+	SIZE szThumbnail = { pSource->GetWidth(), pSource->GetHeight() };
+	UICollectionViewThumbnailPtr pThumbnail = Allocate(szThumbnail);
+	if (!pThumbnail) return pThumbnail;
+
+	// make sure GDI has finished drawing into the source.
+	::GdiFlush();
+	for (int y = 0; y < szThumbnail.cy; y ++) {
+		memcpy(pThumbnail->GetBits() + y * pThumbnail->GetStride(), pSource->GetBits() + y * pSource->GetStride(), 
+			szThumbnail.cx * sizeof(DWORD));
+	}
+	return pThumbnail;
+}
+
+// Get the number of pages.
+int UICollectionViewThumbnailAtlas::GetPageCount() const
+{
+	return (int)m_pState->Pages.size();
+}
+
+// Get the number of slots in use.
+int UICollectionViewThumbnailAtlas::GetSlotsInUse() const
+{
+	return m_pState->nSlotsInUse;
+}
+
+// Get the number of slots in use on a page.
+int UICollectionViewThumbnailAtlas::GetSlotsInUse(const void *pPage) const
+{
+	for (auto itr = m_pState->Pages.begin(); itr != m_pState->Pages.end(); itr ++) {
+		if (*itr == pPage) return (*itr)->nUsed;
+	}
+	return 0;
+}
+
+// Get the memory consumed by pages, including free slots.
+SIZE_T UICollectionViewThumbnailAtlas::GetByteSize() const
+{
+	SIZE_T nPageBytes = (SIZE_T)m_pState->nColumns * m_pState->szSlot.cx * m_pState->nRows * m_pState->szSlot.cy * sizeof(DWORD);
+	return nPageBytes * m_pState->Pages.size();
+}
+
+// Get the number of slots per page so that a page takes no more than `nPageBytes`, at least one.
+int UICollectionViewThumbnailAtlas::GetSlotsPerPage(SIZE szSlot, SIZE_T nPageBytes)
+{
+	SIZE_T nSlotBytes = (SIZE_T)szSlot.cx * szSlot.cy * sizeof(DWORD);
+	if (nSlotBytes == 0) return 1;
+	return (int)min(max(nPageBytes / nSlotBytes, (SIZE_T)1), (SIZE_T)256);
+}
+
+// Allocate a thumbnail at the top left corner of a free slot.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailAtlas::Allocate(SIZE szThumbnail)
+{
+	State *pState = m_pState.get();
+	if (szThumbnail.cx <= 0 || szThumbnail.cy <= 0 || 
+		szThumbnail.cx > pState->szSlot.cx || szThumbnail.cy > pState->szSlot.cy) 
+		return UICollectionViewThumbnailPtr();
+
+	// fill pages in order, so thumbnails stay close to each other.
+	Page *pPage = nullptr;
+	for (auto itr = pState->Pages.begin(); itr != pState->Pages.end(); itr ++) {
+		if (!(*itr)->FreeSlots.empty()) { pPage = *itr; break; }
+	}
+	if (!pPage) pPage = pState->AddPage();
+	if (!pPage) return UICollectionViewThumbnailPtr();
+
+	int nSlot = pPage->FreeSlots.back();
+	pPage->FreeSlots.pop_back();
+	pPage->nUsed ++;
+	pState->nSlotsInUse ++;
+
+	// locate the slot within the page.
+	int nPageWidth = pState->nColumns * pState->szSlot.cx;
+	RECT rcSlot;
+	rcSlot.left = (nSlot % pState->nColumns) * pState->szSlot.cx;
+	rcSlot.top = (nSlot / pState->nColumns) * pState->szSlot.cy;
+	rcSlot.right = rcSlot.left + szThumbnail.cx;
+	rcSlot.bottom = rcSlot.top + szThumbnail.cy;
+
+	// the slot gives itself back to the page when the last thumbnail reference is gone.
+	std::shared_ptr<State> pOwner = m_pState;
+	std::shared_ptr<void> pSlot(pPage, [pOwner, nSlot](Page *pPage) { pOwner->Release(pPage, nSlot); });
+
+	UICollectionViewThumbnailPtr pThumbnail(new UICollectionViewThumbnail(pPage->hBitmap, pPage->pBits, nPageWidth, rcSlot, pSlot));
+
+	// clear pixels left by the previous owner.
+	::GdiFlush();
+	for (int y = 0; y < szThumbnail.cy; y ++) {
+		memset(pThumbnail->GetBits() + y * pThumbnail->GetStride(), 0, szThumbnail.cx * sizeof(DWORD));
+	}
+	return pThumbnail;
+}
+
+// Destructor of the shared state.
+UICollectionViewThumbnailAtlas::State::~State()
+{
+	for (auto itr = Pages.begin(); itr != Pages.end(); itr ++) {
+		::DeleteObject((*itr)->hBitmap);
+		delete *itr;
+	}
+	Pages.clear();
+}
+
+// Create an empty page.
+UICollectionViewThumbnailAtlas::Page* UICollectionViewThumbnailAtlas::State::AddPage()
+{
+	BITMAPINFO bmi;
+	memset(&bmi, 0, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = nColumns * szSlot.cx;
+	bmi.bmiHeader.biHeight = -(nRows * szSlot.cy);
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	DWORD *pBits = nullptr;
+	HBITMAP hBitmap = ::CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, (void **)&pBits, NULL, 0);
+	if (!hBitmap || !pBits) {
+		if (hBitmap) ::DeleteObject(hBitmap);
+		return nullptr;
+	}
+
+	Page *pPage = new Page;
+	pPage->hBitmap = hBitmap;
+	pPage->pBits = pBits;
+	pPage->nUsed = 0;
+	for (int i = nColumns * nRows - 1; i >= 0; i --) 
+		pPage->FreeSlots.push_back(i);
+	Pages.push_back(pPage);
+	return pPage;
+}
+
+// Give a slot back to its page.
+void UICollectionViewThumbnailAtlas::State::Release(Page *pPage, int nSlot)
+{
+	pPage->FreeSlots.push_back(nSlot);
+	pPage->nUsed --;
+	nSlotsInUse --;
+
+	// free empty pages, pages are charged to the cache budget.
+	if (pPage->nUsed == 0) {
+		Pages.erase(std::find(Pages.begin(), Pages.end(), pPage));
+		::DeleteObject(pPage->hBitmap);
+		delete pPage;
+	}
+}
+
+}
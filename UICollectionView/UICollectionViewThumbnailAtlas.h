@@ -0,0 +1,89 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+#include "UICollectionViewThumbnailCache.h"
+#include <memory>
+#include <vector>
+
+namespace DuiLib
+{
+
+// An atlas packs same-size thumbnails into large shared pages, each page is a single 32bpp DIB section
+// divided into a grid of slots. A thumbnail allocated from the atlas refers to (page, slot) instead of
+// owning a bitmap handle, and gives its slot back when the last reference is released. Pages that
+// become empty are freed, so evicting thumbnails gives the memory back.
+class UICollectionViewThumbnailAtlas
+{
+public:
+
+	// Constructor, each page holds `nColumns` x `nRows` slots.
+	UICollectionViewThumbnailAtlas(SIZE szSlot, int nColumns = 16, int nRows = 16);
+
+	// Destructor, pages in use are kept alive by their thumbnails.
+	~UICollectionViewThumbnailAtlas();
+
+	// Get the size of each slot.
+	SIZE GetSlotSize() const;
+
+	// Allocate a transparent thumbnail in a free slot, a new page is created if all pages are full.
+	UICollectionViewThumbnailPtr Allocate();
+
+	// Copy a thumbnail into a free slot, the source must not be larger than the slot.
+	UICollectionViewThumbnailPtr Pack(const UICollectionViewThumbnail *pSource);
+
+	// Get the number of pages.
+	int GetPageCount() const;
+
+	// Get the number of slots in use.
+	int GetSlotsInUse() const;
+
+	// Get the number of slots in use on a page, see `UICollectionViewThumbnail::GetPage()`.
+	int GetSlotsInUse(const void *pPage) const;
+
+	// Get the memory consumed by pages, including free slots.
+	SIZE_T GetByteSize() const;
+
+	// Get the number of slots per page so that a page takes no more than `nPageBytes`, at least one.
+	static int GetSlotsPerPage(SIZE szSlot, SIZE_T nPageBytes);
+
+protected:
+
+	// Allocate a thumbnail at the top left corner of a free slot.
+	UICollectionViewThumbnailPtr Allocate(SIZE szThumbnail);
+
+private:
+
+	// A page of slots.
+	struct Page
+	{
+		HBITMAP hBitmap;
+		DWORD *pBits;
+		int nUsed;
+		std::vector<int> FreeSlots; // lowest slot at the back.
+	};
+
+	// Pages are shared with the thumbnails, so they can outlive the atlas.
+	struct State
+	{
+		SIZE szSlot;
+		int nColumns;
+		int nRows;
+		int nSlotsInUse;
+		std::vector<Page *> Pages;
+
+		~State();
+		Page* AddPage();
+		void Release(Page *pPage, int nSlot);
+	};
+
+	std::shared_ptr<State> m_pState;
+};
+
+}
@@ -0,0 +1,337 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewThumbnailCache.h"
+#include "UICollectionViewThumbnailAtlas.h"
+#include <set>
+#include <vector>
+
+namespace DuiLib
+{
+
+// Constructor, allocate a transparent bitmap in the given size.
+UICollectionViewThumbnail::UICollectionViewThumbnail(int nWidth, int nHeight)
+	:m_hBitmap(NULL), m_pBits(nullptr), m_nWidth(nWidth), m_nHeight(nHeight), m_nStride(nWidth), m_bOwnsBitmap(true)
+{
+	CreateBitmap(NULL, 0);
+	if (m_pBits) memset(m_pBits, 0, GetByteSize());
+}
+
+// Constructor, map the bitmap onto existing pixels of a file mapping, `pOwner` keeps the mapping alive.
+UICollectionViewThumbnail::UICollectionViewThumbnail(int nWidth, int nHeight, HANDLE hSection, DWORD dwOffset, std::shared_ptr<void> pOwner)
+	:m_hBitmap(NULL), m_pBits(nullptr), m_nWidth(nWidth), m_nHeight(nHeight), m_nStride(nWidth), m_bOwnsBitmap(true),
+	 m_pOwner(pOwner)
+{
+	CreateBitmap(hSection, dwOffset);
+}
+
+// Constructor, refer to a slot of an atlas page, `pOwner` releases the slot when the thumbnail is destroyed.
+UICollectionViewThumbnail::UICollectionViewThumbnail(HBITMAP hPage, DWORD *pPageBits, int nPageWidth, RECT rcSlot, std::shared_ptr<void> pOwner)
+	:m_hBitmap(hPage), m_pBits(pPageBits + rcSlot.top * nPageWidth + rcSlot.left), m_nWidth(rcSlot.right - rcSlot.left),
+	 m_nHeight(rcSlot.bottom - rcSlot.top), m_nStride(nPageWidth), m_rcSource(rcSlot), m_bOwnsBitmap(false), m_pOwner(pOwner)
+{
+}
+
+// Destructor.
+UICollectionViewThumbnail::~UICollectionViewThumbnail()
+{
+	if (m_hBitmap && m_bOwnsBitmap) ::DeleteObject(m_hBitmap);
+}
+
+// Create the DIB section, on a file mapping if `hSection` is not NULL.
+void UICollectionViewThumbnail::CreateBitmap(HANDLE hSection, DWORD dwOffset)
+{
+	ASSERT(m_nWidth > 0 && m_nHeight > 0);
+	::SetRect(&m_rcSource, 0, 0, m_nWidth, m_nHeight);
+
+	// negative height for a top-down DIB.
+	BITMAPINFO bmi;
+	memset(&bmi, 0, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = m_nWidth;
+	bmi.bmiHeader.biHeight = -m_nHeight;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	m_hBitmap = ::CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, (void **)&m_pBits, hSection, dwOffset);
+	if (!m_hBitmap || !m_pBits) {
+		if (m_hBitmap) ::DeleteObject(m_hBitmap);
+		m_hBitmap = NULL;
+		m_pBits = nullptr;
+		m_nWidth = m_nHeight = m_nStride = 0;
+		::SetRectEmpty(&m_rcSource);
+	}
+}
+
+// Stretch and alpha blend the thumbnail into the destination rect.
+void UICollectionViewThumbnail::Draw(HDC hDC, const RECT &rc, const RECT &rcPaint) const
+{
+	if (!m_hBitmap) return;
+
+	RECT rcScale9 = { 0 };
+	CRenderEngine::DrawImage(hDC, m_hBitmap, rc, rcPaint, m_rcSource, rcScale9, true);
+}
+
+// Resample another thumbnail into this one, see `UICollectionViewImageScaler`.
+bool UICollectionViewThumbnail::ScaleFrom(const UICollectionViewThumbnail *pSource, UICollectionViewImageScaler::Filter filter)
+{
+	if (!m_pBits || !pSource || !pSource->GetBits()) return false;
+
+	// pixels may still be drawn by GDI.
+	::GdiFlush();
+	return UICollectionViewImageScaler::Scale((const uint32_t *)pSource->GetBits(), pSource->GetWidth(), pSource->GetHeight(),
+		pSource->GetStride(), (uint32_t *)m_pBits, m_nWidth, m_nHeight, m_nStride, filter);
+}
+
+// Constructor.
+UICollectionViewThumbnailCache::UICollectionViewThumbnailCache(SIZE_T nBudget)
+	:m_nBudget(nBudget), m_nBytes(0), m_nHits(0), m_nMisses(0), m_nEvictions(0), m_nRescales(0), m_bPacking(FALSE)
+{
+}
+
+// Destructor.
+UICollectionViewThumbnailCache::~UICollectionViewThumbnailCache()
+{
+	RemoveAll();
+
+	// pages in use are kept alive by their thumbnails.
+	for (auto itr = m_Atlases.begin(); itr != m_Atlases.end(); itr ++) {
+		delete itr->second;
+	}
+	m_Atlases.clear();
+}
+
+// Map a thumbnail size to its bucket, i.e. the longer edge rounded up to the power of two.
+int UICollectionViewThumbnailCache::GetSizeBucket(SIZE szThumbnail)
+{
+	int nEdge = max(szThumbnail.cx, szThumbnail.cy);
+	int nBucket = 16; // the smallest bucket.
+	while (nBucket < nEdge) nBucket <<= 1;
+	return nBucket;
+}
+
+// Create an empty thumbnail to decode into, it is allocated from an atlas in packing mode.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailCache::CreateThumbnail(SIZE szThumbnail)
+{
+	if (szThumbnail.cx <= 0 || szThumbnail.cy <= 0) return UICollectionViewThumbnailPtr();
+
+	UICollectionViewThumbnailPtr pThumbnail;
+	if (m_bPacking) pThumbnail = GetAtlas(szThumbnail)->Allocate();
+	if (!pThumbnail) pThumbnail.reset(new UICollectionViewThumbnail(szThumbnail.cx, szThumbnail.cy));
+	return pThumbnail->GetBitmap() ? pThumbnail : UICollectionViewThumbnailPtr();
+}
+
+// Return the cached thumbnail, or an empty pointer on a miss.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailCache::Lookup(LPCTSTR pstrIdentifier, SIZE szThumbnail)
+{
+	auto itr = m_Index.find(Key(pstrIdentifier, GetSizeBucket(szThumbnail)));
+	if (itr == m_Index.end()) {
+		m_nMisses ++;
+		return UICollectionViewThumbnailPtr();
+	}
+
+	// move to the front as the most recently used one.
+	m_Entries.splice(m_Entries.begin(), m_Entries, itr->second);
+	m_nHits ++;
+	return itr->second->second;
+}
+
+// Same as `Lookup`, but on a miss the nearest larger thumbnail of the item is downscaled and cached.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailCache::LookupNearest(LPCTSTR pstrIdentifier, SIZE szThumbnail)
+{
+	std::wstring sIdentifier(pstrIdentifier);
+	int nBucket = GetSizeBucket(szThumbnail);
+	auto itr = m_Index.find(Key(sIdentifier, nBucket));
+	if (itr != m_Index.end()) return Lookup(pstrIdentifier, szThumbnail);
+
+	// buckets of an item are adjacent in the index, ordered from the smallest.
+	for (itr = m_Index.upper_bound(Key(sIdentifier, nBucket)); itr != m_Index.end() && itr->first.first == sIdentifier; itr ++) {
+		UICollectionViewThumbnailPtr pSource = itr->second->second;
+		if (pSource->GetWidth() < szThumbnail.cx || pSource->GetHeight() < szThumbnail.cy) continue;
+
+		UICollectionViewThumbnailPtr pThumbnail = CreateThumbnail(szThumbnail);
+		if (!pThumbnail || !pThumbnail->ScaleFrom(pSource.get())) break;
+
+		m_Entries.splice(m_Entries.begin(), m_Entries, itr->second);
+		m_nHits ++;
+		m_nRescales ++;
+		return Insert(pstrIdentifier, szThumbnail, pThumbnail);
+	}
+
+	m_nMisses ++;
+	return UICollectionViewThumbnailPtr();
+}
+
+// Add or replace a thumbnail, least recently used thumbnails will be evicted if the budget is exceeded.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailCache::Insert(LPCTSTR pstrIdentifier, SIZE szThumbnail, UICollectionViewThumbnailPtr pThumbnail)
+{
+	if (!pThumbnail || !pThumbnail->GetBitmap()) return pThumbnail;
+
+	// repack a standalone thumbnail, its own bitmap is released once the caller drops it.
+	if (m_bPacking && !pThumbnail->IsPacked()) {
+		SIZE szPacked = { pThumbnail->GetWidth(), pThumbnail->GetHeight() };
+		UICollectionViewThumbnailPtr pPacked = GetAtlas(szPacked)->Pack(pThumbnail.get());
+		if (pPacked) pThumbnail = pPacked;
+	}
+
+	Key key(pstrIdentifier, GetSizeBucket(szThumbnail));
+	auto itr = m_Index.find(key);
+	if (itr != m_Index.end()) {
+		if (!itr->second->second->IsPacked()) m_nBytes -= itr->second->second->GetByteSize();
+		m_Entries.erase(itr->second);
+		m_Index.erase(itr);
+	}
+
+	m_Entries.push_front(Entry(key, pThumbnail));
+	m_Index[key] = m_Entries.begin();
+	if (!pThumbnail->IsPacked()) m_nBytes += pThumbnail->GetByteSize();
+
+	Trim();
+	return pThumbnail;
+}
+
+// Remove thumbnails of an item in all size buckets.
+void UICollectionViewThumbnailCache::Remove(LPCTSTR pstrIdentifier)
+{
+	std::wstring sIdentifier(pstrIdentifier);
+	auto itr = m_Index.lower_bound(Key(sIdentifier, 0));
+	while (itr != m_Index.end() && itr->first.first == sIdentifier) {
+		if (!itr->second->second->IsPacked()) m_nBytes -= itr->second->second->GetByteSize();
+		m_Entries.erase(itr->second);
+		itr = m_Index.erase(itr);
+	}
+}
+
+// Remove all thumbnails.
+void UICollectionViewThumbnailCache::RemoveAll()
+{
+	m_Index.clear();
+	m_Entries.clear();
+	m_nBytes = 0;
+}
+
+// Set the memory budget in bytes.
+void UICollectionViewThumbnailCache::SetBudget(SIZE_T nBudget)
+{
+	m_nBudget = nBudget;
+
+	// atlases without pages are created again with pages sized to the new budget.
+	for (auto itr = m_Atlases.begin(); itr != m_Atlases.end(); ) {
+		if (itr->second->GetPageCount() > 0) { itr ++; continue; }
+		delete itr->second;
+		itr = m_Atlases.erase(itr);
+	}
+	Trim();
+}
+
+// Get hit / miss / eviction counters.
+UICollectionViewThumbnailCacheStats UICollectionViewThumbnailCache::GetStats() const
+{
+	UICollectionViewThumbnailCacheStats stats;
+	stats.nHits = m_nHits;
+	stats.nMisses = m_nMisses;
+	stats.nEvictions = m_nEvictions;
+	stats.nRescales = m_nRescales;
+	stats.nBytes = GetChargedBytes();
+	stats.nBudget = m_nBudget;
+	stats.nCount = (int)m_Entries.size();
+	stats.nAtlasPages = 0;
+	for (auto itr = m_Atlases.begin(); itr != m_Atlases.end(); itr ++) {
+		stats.nAtlasPages += itr->second->GetPageCount();
+	}
+	return stats;
+}
+
+// Reset hit / miss / eviction / rescale counters.
+void UICollectionViewThumbnailCache::ResetStats()
+{
+	m_nHits = m_nMisses = m_nEvictions = m_nRescales = 0;
+}
+
+// Evict least recently used thumbnails until we are under budget.
+void UICollectionViewThumbnailCache::Trim()
+{
+	// always keep the most recently used one even if it is larger than the budget. pages pinned by displayed
+	// thumbnails can't be freed, the cache stays over budget then instead of evicting everything else.
+	while (GetChargedBytes() > m_nBudget && m_Entries.size() > 1) {
+		if (!EvictLeastRecentlyUsed()) break;
+	}
+}
+
+// Evict the least recently used standalone thumbnail, or all thumbnails of the least recently used free atlas page.
+bool UICollectionViewThumbnailCache::EvictLeastRecentlyUsed()
+{
+	std::set<const void *> sVisitedPages;
+	// the most recently used one is kept.
+	for (auto itr = std::prev(m_Entries.end()); itr != m_Entries.begin(); itr --) {
+		const UICollectionViewThumbnailPtr &pThumbnail = itr->second;
+		if (!pThumbnail->IsPacked()) {
+			m_nBytes -= pThumbnail->GetByteSize();
+			m_Index.erase(itr->first);
+			m_Entries.erase(itr);
+			m_nEvictions ++;
+			return true;
+		}
+
+		// a page is only freed once all of its slots are released, evicting a part of it frees nothing.
+		const void *pPage = pThumbnail->GetPage();
+		if (!sVisitedPages.insert(pPage).second) continue;
+
+		std::vector<std::list<Entry>::iterator> victims;
+		bool bPinned = false;
+		for (auto entry = std::next(m_Entries.begin()); entry != m_Entries.end() && !bPinned; entry ++) {
+			if (entry->second->GetPage() != pPage) continue;
+			bPinned = entry->second.use_count() > 1; // displayed by an item view.
+			victims.push_back(entry);
+		}
+		if (m_Entries.front().second->GetPage() == pPage) bPinned = true;
+
+		// slots evicted before may still be displayed.
+		int nSlotsInUse = 0;
+		for (auto atlas = m_Atlases.begin(); atlas != m_Atlases.end(); atlas ++) nSlotsInUse += atlas->second->GetSlotsInUse(pPage);
+		if (bPinned || nSlotsInUse != (int)victims.size()) continue;
+
+		for (size_t i = 0; i < victims.size(); i ++) {
+			m_Index.erase(victims[i]->first);
+			m_Entries.erase(victims[i]);
+			m_nEvictions ++;
+		}
+		return true;
+	}
+	return false;
+}
+
+// Get the memory charged to the budget, i.e. standalone thumbnails plus atlas pages.
+SIZE_T UICollectionViewThumbnailCache::GetChargedBytes() const
+{
+	SIZE_T nBytes = m_nBytes;
+	for (auto itr = m_Atlases.begin(); itr != m_Atlases.end(); itr ++) {
+		nBytes += itr->second->GetByteSize();
+	}
+	return nBytes;
+}
+
+// Get the atlas of the given thumbnail size, create one if needed.
+UICollectionViewThumbnailAtlas* UICollectionViewThumbnailCache::GetAtlas(SIZE szThumbnail)
+{
+	std::pair<int, int> key(szThumbnail.cx, szThumbnail.cy);
+	auto itr = m_Atlases.find(key);
+	if (itr != m_Atlases.end()) return itr->second;
+
+	// a page takes at most 1/16 of the budget, laid out as a near square grid.
+	int nSlots = UICollectionViewThumbnailAtlas::GetSlotsPerPage(szThumbnail, m_nBudget / 16);
+	int nColumns = 1;
+	while ((nColumns + 1) * (nColumns + 1) <= nSlots) nColumns ++;
+
+	UICollectionViewThumbnailAtlas *pAtlas = new UICollectionViewThumbnailAtlas(szThumbnail, nColumns, nSlots / nColumns);
+	m_Atlases[key] = pAtlas;
+	return pAtlas;
+}
+
+}
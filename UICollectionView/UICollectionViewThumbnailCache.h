@@ -0,0 +1,199 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+#include "UICollectionViewImageScaler.h"
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace DuiLib
+{
+
+// Default memory budget of the thumbnail cache (64MB).
+static const SIZE_T UICollectionViewThumbnailCacheDefaultBudget = 64 * 1024 * 1024;
+
+// A decoded thumbnail, stored as a 32bpp top-down DIB section with premultiplied alpha. The thumbnail
+// either owns its bitmap, or occupies a slot of a page shared with other thumbnails in an atlas.
+class UICollectionViewThumbnail
+{
+public:
+
+	// Constructor, allocate a transparent bitmap in the given size.
+	UICollectionViewThumbnail(int nWidth, int nHeight);
+
+	// Constructor, map the bitmap onto existing pixels of a file mapping, `pOwner` keeps the mapping alive.
+	UICollectionViewThumbnail(int nWidth, int nHeight, HANDLE hSection, DWORD dwOffset, std::shared_ptr<void> pOwner);
+
+	// Constructor, refer to a slot of an atlas page, `pOwner` releases the slot when the thumbnail is destroyed.
+	UICollectionViewThumbnail(HBITMAP hPage, DWORD *pPageBits, int nPageWidth, RECT rcSlot, std::shared_ptr<void> pOwner);
+
+	// Destructor.
+	~UICollectionViewThumbnail();
+
+	// Get the bitmap handle, it can be selected into a memory DC, the thumbnail is at `GetSourceRect()`.
+	HBITMAP GetBitmap() const { return m_hBitmap; }
+
+	// Get the rect of the thumbnail within the bitmap.
+	RECT GetSourceRect() const { return m_rcSource; }
+
+	// Get the first pixel, rows are `GetStride()` pixels apart.
+	DWORD* GetBits() const { return m_pBits; }
+
+	// Get the distance between rows in pixels.
+	int GetStride() const { return m_nStride; }
+
+	// Return TRUE if the thumbnail is packed into an atlas page.
+	BOOL IsPacked() const { return !m_bOwnsBitmap; }
+
+	// Get the atlas page the thumbnail is packed into, nullptr if it owns its bitmap.
+	const void* GetPage() const { return m_bOwnsBitmap ? nullptr : m_pOwner.get(); }
+
+	// Get thumbnail width.
+	int GetWidth() const { return m_nWidth; }
+
+	// Get thumbnail height.
+	int GetHeight() const { return m_nHeight; }
+
+	// Get the memory consumed by pixels.
+	SIZE_T GetByteSize() const { return (SIZE_T)m_nWidth * m_nHeight * sizeof(DWORD); }
+
+	// Stretch and alpha blend the thumbnail into the destination rect.
+	void Draw(HDC hDC, const RECT &rc, const RECT &rcPaint) const;
+
+	// Resample another thumbnail into this one, see `UICollectionViewImageScaler`.
+	bool ScaleFrom(const UICollectionViewThumbnail *pSource, UICollectionViewImageScaler::Filter filter = UICollectionViewImageScaler::FilterBilinear);
+
+private:
+
+	// Create the DIB section, on a file mapping if `hSection` is not NULL.
+	void CreateBitmap(HANDLE hSection, DWORD dwOffset);
+
+private:
+
+	HBITMAP m_hBitmap;
+	DWORD *m_pBits;
+	int m_nWidth;
+	int m_nHeight;
+	int m_nStride;
+	RECT m_rcSource;
+	bool m_bOwnsBitmap;
+	std::shared_ptr<void> m_pOwner; // storage that must outlive the bitmap.
+};
+
+// The thumbnail is shared between the cache and the item views which are displaying it,
+// so an evicted thumbnail remains valid until the last item view releases it.
+typedef std::shared_ptr<UICollectionViewThumbnail> UICollectionViewThumbnailPtr;
+
+// Counters of the thumbnail cache.
+struct UICollectionViewThumbnailCacheStats
+{
+	UINT64 nHits; // lookups answered by the cache.
+	UINT64 nMisses; // lookups that have to be decoded by the caller.
+	UINT64 nEvictions; // thumbnails dropped to stay under budget.
+	UINT64 nRescales; // lookups answered by downscaling a larger cached thumbnail.
+	SIZE_T nBytes; // memory consumed by cached thumbnails and atlas pages.
+	SIZE_T nBudget; // memory budget.
+	int nCount; // number of cached thumbnails.
+	int nAtlasPages; // number of atlas pages in packing mode.
+};
+
+// An LRU cache of decoded thumbnails, keyed by item identifier and size bucket. The cache lives
+// as long as the collection view, so the delegate can check it in `CollectionViewWillDisplayItem`
+// instead of decoding the image again for an item which was recycled moments ago.
+//
+// In packing mode, cached thumbnails are packed into atlases of same-size thumbnails, so thousands
+// of thumbnails share a few large bitmaps instead of owning one bitmap handle each. Atlas pages are
+// charged to the budget as a whole, and each page is sized to a fraction of the budget.
+class UICollectionViewThumbnailAtlas;
+class UICollectionViewThumbnailCache
+{
+public:
+
+	// Constructor.
+	UICollectionViewThumbnailCache(SIZE_T nBudget = UICollectionViewThumbnailCacheDefaultBudget);
+
+	// Destructor.
+	~UICollectionViewThumbnailCache();
+
+	// Map a thumbnail size to its bucket, i.e. the longer edge rounded up to the power of two.
+	static int GetSizeBucket(SIZE szThumbnail);
+
+	// Create an empty thumbnail to decode into, it is allocated from an atlas in packing mode.
+	UICollectionViewThumbnailPtr CreateThumbnail(SIZE szThumbnail);
+
+	// Return the cached thumbnail, or an empty pointer on a miss.
+	UICollectionViewThumbnailPtr Lookup(LPCTSTR pstrIdentifier, SIZE szThumbnail);
+
+	// Same as `Lookup`, but on a miss the nearest larger thumbnail of the item is downscaled to
+	// `szThumbnail` and cached, so the caller only decodes the source image if there is none.
+	UICollectionViewThumbnailPtr LookupNearest(LPCTSTR pstrIdentifier, SIZE szThumbnail);
+
+	// Add or replace a thumbnail, least recently used thumbnails will be evicted if the budget is exceeded.
+	// Return the cached thumbnail, which is a packed copy of `pThumbnail` in packing mode.
+	UICollectionViewThumbnailPtr Insert(LPCTSTR pstrIdentifier, SIZE szThumbnail, UICollectionViewThumbnailPtr pThumbnail);
+
+	// Remove thumbnails of an item in all size buckets.
+	void Remove(LPCTSTR pstrIdentifier);
+
+	// Remove all thumbnails.
+	void RemoveAll();
+
+	// Get the memory budget in bytes.
+	SIZE_T GetBudget() const { return m_nBudget; }
+
+	// Set the memory budget in bytes.
+	void SetBudget(SIZE_T nBudget);
+
+	// Return TRUE if thumbnails are packed into atlases.
+	BOOL IsPackingEnabled() const { return m_bPacking; }
+
+	// Enable or disable packing thumbnails into atlases, it applies to thumbnails inserted afterwards.
+	void SetPackingEnabled(BOOL bPacking) { m_bPacking = bPacking; }
+
+	// Get hit / miss / eviction counters.
+	UICollectionViewThumbnailCacheStats GetStats() const;
+
+	// Reset hit / miss / eviction / rescale counters.
+	void ResetStats();
+
+protected:
+
+	// Evict least recently used thumbnails until we are under budget.
+	void Trim();
+
+	// Get the memory charged to the budget, i.e. standalone thumbnails plus atlas pages.
+	SIZE_T GetChargedBytes() const;
+
+	// Evict the least recently used standalone thumbnail, or all thumbnails of the least recently used atlas page
+	// which no item view displays. Return false if nothing can be evicted.
+	bool EvictLeastRecentlyUsed();
+
+	// Get the atlas of the given thumbnail size, create one if needed.
+	UICollectionViewThumbnailAtlas* GetAtlas(SIZE szThumbnail);
+
+private:
+
+	typedef std::pair<std::wstring, int> Key; // identifier, size bucket.
+	typedef std::pair<Key, UICollectionViewThumbnailPtr> Entry;
+
+	SIZE_T m_nBudget; // memory budget.
+	SIZE_T m_nBytes; // memory of standalone thumbnails, packed ones are charged by their pages.
+	UINT64 m_nHits; // lookup hits.
+	UINT64 m_nMisses; // lookup misses.
+	UINT64 m_nEvictions; // evicted thumbnails.
+	UINT64 m_nRescales; // downscaled thumbnails.
+	BOOL m_bPacking; // pack thumbnails into atlases.
+	std::map<std::pair<int, int>, UICollectionViewThumbnailAtlas *> m_Atlases; // atlases by thumbnail size.
+	std::list<Entry> m_Entries; // most recently used first.
+	std::map<Key, std::list<Entry>::iterator> m_Index; // locate entries by key.
+};
+
+}
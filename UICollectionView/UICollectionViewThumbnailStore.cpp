@@ -0,0 +1,300 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewThumbnailStore.h"
+#include <algorithm>
+
+namespace DuiLib
+{
+
+// File format signature ('UCVT') and version.
+static const DWORD UICollectionViewThumbnailStoreMagic = 0x54564355;
+static const DWORD UICollectionViewThumbnailStoreVersion = 2;
+
+// Constructor.
+UICollectionViewThumbnailStore::UICollectionViewThumbnailStore()
+	:m_hFile(INVALID_HANDLE_VALUE), m_hMapping(NULL), m_pView(nullptr), m_nSlotCount(0)
+{
+	memset(&m_szSlot, 0, sizeof(SIZE));
+}
+
+// Destructor.
+UICollectionViewThumbnailStore::~UICollectionViewThumbnailStore()
+{
+	Close();
+}
+
+// Open or create the store file, the file will be reset if it was created with another slot geometry.
+bool UICollectionViewThumbnailStore::Open(LPCTSTR pstrPath, SIZE szSlot, int nSlotCount)
+{
+	Close();
+	if (szSlot.cx <= 0 || szSlot.cy <= 0 || nSlotCount <= 0) return false;
+
+	// the pixel offsets passed to CreateDIBSection are 32 bits.
+	ULONGLONG nFileSize = sizeof(Header) + (ULONGLONG)nSlotCount * sizeof(Entry) + 
+		(ULONGLONG)nSlotCount * szSlot.cx * szSlot.cy * sizeof(DWORD);
+	if (nFileSize > MAXDWORD) return false;
+
+	m_hFile = ::CreateFile(pstrPath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE) return false;
+
+	// the mapping grows the file to the required size.
+	m_hMapping = ::CreateFileMapping(m_hFile, NULL, PAGE_READWRITE, 0, (DWORD)nFileSize, NULL);
+	if (m_hMapping) m_pView = (LPBYTE)::MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (!m_pView) {
+		if (m_hMapping) ::CloseHandle(m_hMapping);
+		::CloseHandle(m_hFile);
+		m_hMapping = NULL;
+		m_hFile = INVALID_HANDLE_VALUE;
+		return false;
+	}
+	m_pMapping = std::shared_ptr<void>(m_hMapping, ::CloseHandle);
+	m_szSlot = szSlot;
+	m_nSlotCount = nSlotCount;
+
+	// reset the file if it isn't created by the same version with the same geometry.
+	Header *pHeader = (Header *)m_pView;
+	if (pHeader->dwMagic != UICollectionViewThumbnailStoreMagic || 
+		pHeader->dwVersion != UICollectionViewThumbnailStoreVersion ||
+		pHeader->nSlotWidth != szSlot.cx || pHeader->nSlotHeight != szSlot.cy || 
+		pHeader->nSlotCount != nSlotCount) {
+		memset(m_pView, 0, sizeof(Header) + nSlotCount * sizeof(Entry));
+		pHeader->dwMagic = UICollectionViewThumbnailStoreMagic;
+		pHeader->dwVersion = UICollectionViewThumbnailStoreVersion;
+		pHeader->nSlotWidth = szSlot.cx;
+		pHeader->nSlotHeight = szSlot.cy;
+		pHeader->nSlotCount = nSlotCount;
+	}
+
+	// load the index, only the index pages are touched here.
+	m_SlotsInUse.resize(nSlotCount);
+	for (int i = nSlotCount - 1; i >= 0; i --) {
+		Entry *pEntry = GetEntry(i);
+		if (pEntry->nKey == 0 || m_Slots.count(pEntry->nKey)) {
+			pEntry->nKey = 0;
+			m_FreeSlots.push_back(i);
+		} else {
+			m_Slots[pEntry->nKey] = i;
+			m_LruSlots[pEntry->nLastUsed] = i;
+		}
+	}
+
+	return true;
+}
+
+// Flush and close the store file, thumbnails returned before remain valid.
+void UICollectionViewThumbnailStore::Close()
+{
+	if (m_pView) {
+		::FlushViewOfFile(m_pView, 0);
+		::UnmapViewOfFile(m_pView);
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE) ::CloseHandle(m_hFile);
+
+	// the mapping handle is closed when the last thumbnail on it is released.
+	m_pMapping.reset();
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_pView = nullptr;
+	m_nSlotCount = 0;
+	m_Slots.clear();
+	m_LruSlots.clear();
+	m_FreeSlots.clear();
+	m_RetiredSlots.clear();
+	m_SlotsInUse.clear();
+}
+
+// Return the stored thumbnail, or an empty pointer if it is missing or stored for another timestamp.
+UICollectionViewThumbnailPtr UICollectionViewThumbnailStore::Lookup(LPCTSTR pstrIdentifier, UINT64 nTimestamp)
+{
+	if (!m_pView) return UICollectionViewThumbnailPtr();
+
+	int nSlot = FindSlot(pstrIdentifier);
+	if (nSlot < 0) return UICollectionViewThumbnailPtr();
+
+	Entry *pEntry = GetEntry(nSlot);
+	if (pEntry->nTimestamp != nTimestamp) return UICollectionViewThumbnailPtr();
+
+	// mark as the most recently used one.
+	Header *pHeader = (Header *)m_pView;
+	m_LruSlots.erase(pEntry->nLastUsed);
+	pEntry->nLastUsed = ++ pHeader->nClock;
+	m_LruSlots[pEntry->nLastUsed] = nSlot;
+
+	// share the bitmap if it is still being displayed.
+	UICollectionViewThumbnailPtr pThumbnail = m_SlotsInUse[nSlot].lock();
+	if (pThumbnail) return pThumbnail;
+
+	// create a bitmap on top of the slot, nothing is copied or decoded.
+	pThumbnail.reset(new UICollectionViewThumbnail(pEntry->nWidth, pEntry->nHeight, m_hMapping, GetSlotOffset(nSlot), m_pMapping));
+	if (!pThumbnail->GetBitmap()) return UICollectionViewThumbnailPtr();
+	m_SlotsInUse[nSlot] = pThumbnail;
+	return pThumbnail;
+}
+
+// Copy a thumbnail into the store.
+bool UICollectionViewThumbnailStore::Store(LPCTSTR pstrIdentifier, UINT64 nTimestamp, const UICollectionViewThumbnail *pThumbnail)
+{
+	if (!m_pView || !pThumbnail || !pThumbnail->GetBits()) return false;
+	if (pThumbnail->GetWidth() > m_szSlot.cx || pThumbnail->GetHeight() > m_szSlot.cy) return false;
+
+	// reuse the slot of the same key unless it is being displayed, otherwise take a free or the least recently used one.
+	// pixels on screen are never overwritten, the displayed slot is retired instead. an identifier with the same key
+	// replaces the stored one.
+	ReclaimRetiredSlots();
+	UINT64 nKey = HashIdentifier(pstrIdentifier);
+	int nSlot = -1;
+	auto itr = m_Slots.find(nKey);
+	if (itr != m_Slots.end() && m_SlotsInUse[itr->second].expired()) {
+		nSlot = itr->second;
+	} else {
+		nSlot = FindVictimSlot();
+		if (nSlot < 0) return false;
+		if (itr != m_Slots.end()) RetireSlot(itr->second);
+	}
+	ASSERT(m_SlotsInUse[nSlot].expired());
+
+	Entry *pEntry = GetEntry(nSlot);
+	if (pEntry->nKey != 0) {
+		m_Slots.erase(pEntry->nKey);
+		m_LruSlots.erase(pEntry->nLastUsed);
+	} else {
+		m_FreeSlots.erase(std::find(m_FreeSlots.begin(), m_FreeSlots.end(), nSlot));
+	}
+
+	// the entry is invalidated before its pixels are overwritten and published after them, so a crash never leaves
+	// a valid entry on garbage pixels.
+	pEntry->nKey = 0;
+	::FlushViewOfFile(pEntry, sizeof(Entry));
+
+	// make sure GDI has finished drawing into the source, slots are stored without row padding.
+	::GdiFlush();
+	DWORD *pSlotBits = (DWORD *)(m_pView + GetSlotOffset(nSlot));
+	for (int y = 0; y < pThumbnail->GetHeight(); y ++) {
+		memcpy(pSlotBits + y * pThumbnail->GetWidth(), pThumbnail->GetBits() + y * pThumbnail->GetStride(), 
+			pThumbnail->GetWidth() * sizeof(DWORD));
+	}
+	::FlushViewOfFile(pSlotBits, (SIZE_T)pThumbnail->GetWidth() * pThumbnail->GetHeight() * sizeof(DWORD));
+
+	Header *pHeader = (Header *)m_pView;
+	pEntry->nTimestamp = nTimestamp;
+	pEntry->nWidth = pThumbnail->GetWidth();
+	pEntry->nHeight = pThumbnail->GetHeight();
+	pEntry->nLastUsed = ++ pHeader->nClock;
+	pEntry->nCheck = CheckIdentifier(pstrIdentifier);
+	pEntry->nLength = (LONG)_tcslen(pstrIdentifier);
+	pEntry->nKey = nKey;
+	m_Slots[nKey] = nSlot;
+	m_LruSlots[pEntry->nLastUsed] = nSlot;
+	m_SlotsInUse[nSlot].reset();
+	return true;
+}
+
+// Forget a stored thumbnail.
+void UICollectionViewThumbnailStore::Remove(LPCTSTR pstrIdentifier)
+{
+	if (!m_pView) return;
+
+	int nSlot = FindSlot(pstrIdentifier);
+	if (nSlot < 0) return;
+
+	RetireSlot(nSlot);
+}
+
+// Write dirty pages back to the file.
+void UICollectionViewThumbnailStore::Flush()
+{
+	if (m_pView) ::FlushViewOfFile(m_pView, 0);
+}
+
+// Hash an identifier into a 64 bits key (FNV-1a).
+UINT64 UICollectionViewThumbnailStore::HashIdentifier(LPCTSTR pstrIdentifier)
+{
+	UINT64 nHash = 14695981039346656037ULL;
+	for (LPCTSTR p = pstrIdentifier; *p; p ++) {
+		nHash ^= (UINT64)(*p);
+		nHash *= 1099511628211ULL;
+	}
+	return nHash ? nHash : 1; // zero is reserved for empty slots.
+}
+
+// Hash an identifier into a 64 bits check, independent from its key.
+UINT64 UICollectionViewThumbnailStore::CheckIdentifier(LPCTSTR pstrIdentifier)
+{
+	// multiply and fold each character in, unlike FNV-1a identifiers colliding on the key don't collide here.
+	UINT64 nHash = 0x9E3779B97F4A7C15ULL;
+	for (LPCTSTR p = pstrIdentifier; *p; p ++) {
+		nHash ^= (UINT64)(*p);
+		nHash *= 0xFF51AFD7ED558CCDULL;
+		nHash ^= nHash >> 33;
+	}
+	return nHash;
+}
+
+// Get the slot storing an identifier, -1 if there is none.
+int UICollectionViewThumbnailStore::FindSlot(LPCTSTR pstrIdentifier) const
+{
+	auto itr = m_Slots.find(HashIdentifier(pstrIdentifier));
+	if (itr == m_Slots.end()) return -1;
+
+	Entry *pEntry = GetEntry(itr->second);
+	if (pEntry->nCheck != CheckIdentifier(pstrIdentifier) || pEntry->nLength != (LONG)_tcslen(pstrIdentifier)) return -1;
+	return itr->second;
+}
+
+// Get the index entry of a slot.
+UICollectionViewThumbnailStore::Entry* UICollectionViewThumbnailStore::GetEntry(int nSlot) const
+{
+	ASSERT(nSlot >= 0 && nSlot < m_nSlotCount);
+	return (Entry *)(m_pView + sizeof(Header)) + nSlot;
+}
+
+// Get the file offset of a slot's pixels.
+DWORD UICollectionViewThumbnailStore::GetSlotOffset(int nSlot) const
+{
+	return (DWORD)(sizeof(Header) + m_nSlotCount * sizeof(Entry) + (SIZE_T)nSlot * m_szSlot.cx * m_szSlot.cy * sizeof(DWORD));
+}
+
+// Pick a slot to overwrite, return -1 if all slots are being displayed.
+int UICollectionViewThumbnailStore::FindVictimSlot() const
+{
+	if (!m_FreeSlots.empty()) return m_FreeSlots.back();
+
+	// never overwrite pixels which are on screen.
+	for (auto itr = m_LruSlots.begin(); itr != m_LruSlots.end(); itr ++) {
+		if (m_SlotsInUse[itr->second].expired()) return itr->second;
+	}
+	return -1;
+}
+
+// Drop the index entry of a slot, the slot is freed once its pixels aren't displayed any more.
+void UICollectionViewThumbnailStore::RetireSlot(int nSlot)
+{
+	Entry *pEntry = GetEntry(nSlot);
+	m_Slots.erase(pEntry->nKey);
+	m_LruSlots.erase(pEntry->nLastUsed);
+	pEntry->nKey = 0;
+
+	if (m_SlotsInUse[nSlot].expired()) m_FreeSlots.push_back(nSlot);
+	else m_RetiredSlots.push_back(nSlot);
+}
+
+// Free retired slots which aren't displayed any more.
+void UICollectionViewThumbnailStore::ReclaimRetiredSlots()
+{
+	for (auto itr = m_RetiredSlots.begin(); itr != m_RetiredSlots.end();) {
+		if (m_SlotsInUse[*itr].expired()) {
+			m_FreeSlots.push_back(*itr);
+			itr = m_RetiredSlots.erase(itr);
+		} else {
+			itr ++;
+		}
+	}
+}
+
+}
@@ -0,0 +1,127 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+#include "UICollectionViewThumbnailCache.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace DuiLib
+{
+
+// A persistent thumbnail store, which is a memory-mapped file made up of a header, an index and
+// a fixed number of fixed-size pixel slots:
+//
+//   [header] [index entry 0 .. n-1] [slot 0 pixels .. slot n-1 pixels]
+//
+// Thumbnails are looked up by item identifier and source timestamp, a stale timestamp is a miss.
+// The returned thumbnail is a DIB section created on top of the mapping, so painting reads the
+// pixels straight from the file cache without decoding anything. When all slots are in use, the
+// least recently used slot which is not being displayed will be overwritten.
+class UICollectionViewThumbnailStore
+{
+public:
+
+	// Constructor.
+	UICollectionViewThumbnailStore();
+
+	// Destructor.
+	~UICollectionViewThumbnailStore();
+
+	// Open or create the store file, the file will be reset if it was created with another slot geometry.
+	bool Open(LPCTSTR pstrPath, SIZE szSlot, int nSlotCount);
+
+	// Flush and close the store file, thumbnails returned before remain valid.
+	void Close();
+
+	// Return TRUE if the store file is opened.
+	BOOL IsOpen() const { return m_pView != nullptr; }
+
+	// Get the size of each pixel slot, larger thumbnails can't be stored.
+	SIZE GetSlotSize() const { return m_szSlot; }
+
+	// Return the stored thumbnail, or an empty pointer if it is missing or stored for another timestamp.
+	UICollectionViewThumbnailPtr Lookup(LPCTSTR pstrIdentifier, UINT64 nTimestamp);
+
+	// Copy a thumbnail into the store.
+	bool Store(LPCTSTR pstrIdentifier, UINT64 nTimestamp, const UICollectionViewThumbnail *pThumbnail);
+
+	// Forget a stored thumbnail.
+	void Remove(LPCTSTR pstrIdentifier);
+
+	// Write dirty pages back to the file.
+	void Flush();
+
+protected:
+
+	// Header at the beginning of the file.
+	struct Header
+	{
+		DWORD dwMagic;
+		DWORD dwVersion;
+		LONG nSlotWidth;
+		LONG nSlotHeight;
+		LONG nSlotCount;
+		DWORD dwReserved;
+		UINT64 nClock; // increased on every use, saved into `Entry::nLastUsed`.
+	};
+
+	// Index entry of a slot.
+	struct Entry
+	{
+		UINT64 nKey; // hash of the identifier, zero for an empty slot.
+		UINT64 nCheck; // second hash of the identifier, tells identifiers with the same key apart.
+		UINT64 nTimestamp; // timestamp of the source image.
+		UINT64 nLastUsed; // for LRU replacement.
+		LONG nWidth; // thumbnail width.
+		LONG nHeight; // thumbnail height.
+		LONG nLength; // length of the identifier.
+	};
+
+	// Hash an identifier into a 64 bits key (FNV-1a).
+	static UINT64 HashIdentifier(LPCTSTR pstrIdentifier);
+
+	// Hash an identifier into a 64 bits check, independent from its key.
+	static UINT64 CheckIdentifier(LPCTSTR pstrIdentifier);
+
+	// Get the slot storing an identifier, -1 if there is none. Keys may collide, the check and length are compared too.
+	int FindSlot(LPCTSTR pstrIdentifier) const;
+
+	// Get the index entry of a slot.
+	Entry* GetEntry(int nSlot) const;
+
+	// Get the file offset of a slot's pixels.
+	DWORD GetSlotOffset(int nSlot) const;
+
+	// Pick a slot to overwrite, return -1 if all slots are being displayed.
+	int FindVictimSlot() const;
+
+	// Drop the index entry of a slot, the slot is freed once its pixels aren't displayed any more.
+	void RetireSlot(int nSlot);
+
+	// Free retired slots which aren't displayed any more.
+	void ReclaimRetiredSlots();
+
+private:
+
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+	LPBYTE m_pView;
+	SIZE m_szSlot;
+	int m_nSlotCount;
+	std::shared_ptr<void> m_pMapping; // shared with thumbnails created on the mapping.
+	std::map<UINT64, int> m_Slots; // key -> slot.
+	std::map<UINT64, int> m_LruSlots; // last used -> slot, least recently used first.
+	std::vector<int> m_FreeSlots; // empty slots, none of them is being displayed.
+	std::vector<int> m_RetiredSlots; // empty slots still being displayed.
+	std::vector<std::weak_ptr<UICollectionViewThumbnail> > m_SlotsInUse; // thumbnails being displayed.
+};
+
+}
@@ -0,0 +1,170 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#include "stdafx.h"
+#include "UICollectionViewTileCache.h"
+
+namespace DuiLib
+{
+
+// Constructor.
+UICollectionViewTileCache::UICollectionViewTileCache(int nTileSize, SIZE_T nBudget)
+	:m_nTileSize(nTileSize), m_hMemDC(NULL), m_nBudget(nBudget), m_nRasterized(0), m_nReused(0), m_nEvictions(0),
+	 m_nFrameRasterized(0), m_nFrameReused(0), m_nLastFrameRasterized(0), m_nLastFrameReused(0)
+{
+	ASSERT(m_nTileSize > 0);
+}
+
+// Destructor.
+UICollectionViewTileCache::~UICollectionViewTileCache()
+{
+	RemoveAll();
+	if (m_hMemDC) ::DeleteDC(m_hMemDC);
+}
+
+// Set the edge length of a tile, all tiles are removed.
+void UICollectionViewTileCache::SetTileSize(int nTileSize)
+{
+	if (nTileSize <= 0 || nTileSize == m_nTileSize) return;
+
+	RemoveAll();
+	m_nTileSize = nTileSize;
+}
+
+// Blit the part of a cached tile within `rcPaint`.
+bool UICollectionViewTileCache::Draw(int nColumn, int nRow, HDC hDC, const RECT &rcTile, const RECT &rcPaint)
+{
+	auto itr = m_Index.find(Key(nRow, nColumn));
+	if (itr == m_Index.end()) return false;
+
+	RECT rcPart = { 0 };
+	if (!::IntersectRect(&rcPart, &rcTile, &rcPaint)) return true;
+
+	HBITMAP hOldBitmap = (HBITMAP)::SelectObject(m_hMemDC, itr->second->second);
+	::BitBlt(hDC, rcPart.left, rcPart.top, rcPart.right - rcPart.left, rcPart.bottom - rcPart.top,
+		m_hMemDC, rcPart.left - rcTile.left, rcPart.top - rcTile.top, SRCCOPY);
+	::SelectObject(m_hMemDC, hOldBitmap);
+
+	// move to the front as the most recently used one.
+	m_Entries.splice(m_Entries.begin(), m_Entries, itr->second);
+	m_nReused ++;
+	m_nFrameReused ++;
+	return true;
+}
+
+// Cache a tile by copying the pixels at `rcTile` from the DC.
+bool UICollectionViewTileCache::Rasterize(int nColumn, int nRow, HDC hDC, const RECT &rcTile)
+{
+	if (!m_hMemDC) m_hMemDC = ::CreateCompatibleDC(hDC);
+	if (!m_hMemDC) return false;
+
+	// tiles are opaque, a DDB in the format of the DC blits fastest.
+	HBITMAP hBitmap = ::CreateCompatibleBitmap(hDC, m_nTileSize, m_nTileSize);
+	if (!hBitmap) return false;
+
+	HBITMAP hOldBitmap = (HBITMAP)::SelectObject(m_hMemDC, hBitmap);
+	::BitBlt(m_hMemDC, 0, 0, rcTile.right - rcTile.left, rcTile.bottom - rcTile.top, hDC, rcTile.left, rcTile.top, SRCCOPY);
+	::SelectObject(m_hMemDC, hOldBitmap);
+
+	Key key(nRow, nColumn);
+	auto itr = m_Index.find(key);
+	if (itr != m_Index.end()) {
+		::DeleteObject(itr->second->second);
+		m_Entries.erase(itr->second);
+		m_Index.erase(itr);
+	}
+
+	m_Entries.push_front(Entry(key, hBitmap));
+	m_Index[key] = m_Entries.begin();
+	m_nRasterized ++;
+	m_nFrameRasterized ++;
+
+	Trim();
+	return true;
+}
+
+// Remove tiles intersecting a rect in content coordinates.
+void UICollectionViewTileCache::Invalidate(const RECT &rcContent)
+{
+	if (m_Index.empty() || ::IsRectEmpty(&rcContent)) return;
+
+	// tiles with negative coordinates never exist, the rect may be partially scrolled out though.
+	int nColumnFirst = max(0, (int)rcContent.left) / m_nTileSize;
+	int nColumnLast = max(0, (int)rcContent.right - 1) / m_nTileSize;
+	int nRowFirst = max(0, (int)rcContent.top) / m_nTileSize;
+	int nRowLast = max(0, (int)rcContent.bottom - 1) / m_nTileSize;
+
+	for (int nRow = nRowFirst; nRow <= nRowLast; nRow ++) {
+		auto itr = m_Index.lower_bound(Key(nRow, nColumnFirst));
+		while (itr != m_Index.end() && itr->first.first == nRow && itr->first.second <= nColumnLast) {
+			::DeleteObject(itr->second->second);
+			m_Entries.erase(itr->second);
+			itr = m_Index.erase(itr);
+		}
+	}
+}
+
+// Remove all tiles.
+void UICollectionViewTileCache::RemoveAll()
+{
+	for (auto itr = m_Entries.begin(); itr != m_Entries.end(); itr ++) {
+		::DeleteObject(itr->second);
+	}
+	m_Entries.clear();
+	m_Index.clear();
+}
+
+// Set the memory budget in bytes.
+void UICollectionViewTileCache::SetBudget(SIZE_T nBudget)
+{
+	m_nBudget = nBudget;
+	Trim();
+}
+
+// Start counting tiles of a new frame.
+void UICollectionViewTileCache::BeginFrame()
+{
+	m_nLastFrameRasterized = m_nFrameRasterized;
+	m_nLastFrameReused = m_nFrameReused;
+	m_nFrameRasterized = m_nFrameReused = 0;
+}
+
+// Get rasterized / reused / eviction counters.
+UICollectionViewTileCacheStats UICollectionViewTileCache::GetStats() const
+{
+	UICollectionViewTileCacheStats stats;
+	stats.nRasterized = m_nRasterized;
+	stats.nReused = m_nReused;
+	stats.nEvictions = m_nEvictions;
+	stats.nFrameRasterized = m_nLastFrameRasterized;
+	stats.nFrameReused = m_nLastFrameReused;
+	stats.nBytes = m_Entries.size() * GetTileByteSize();
+	stats.nBudget = m_nBudget;
+	stats.nCount = (int)m_Entries.size();
+	return stats;
+}
+
+// Reset rasterized / reused / eviction counters.
+void UICollectionViewTileCache::ResetStats()
+{
+	m_nRasterized = m_nReused = m_nEvictions = 0;
+	m_nFrameRasterized = m_nFrameReused = m_nLastFrameRasterized = m_nLastFrameReused = 0;
+}
+
+// Evict least recently used tiles until we are under budget.
+void UICollectionViewTileCache::Trim()
+{
+	while (!m_Entries.empty() && m_Entries.size() * GetTileByteSize() > m_nBudget) {
+		Entry &entry = m_Entries.back();
+		::DeleteObject(entry.second);
+		m_Index.erase(entry.first);
+		m_Entries.pop_back();
+		m_nEvictions ++;
+	}
+}
+
+}
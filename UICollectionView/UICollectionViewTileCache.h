@@ -0,0 +1,111 @@
+//
+//  UICollectionView - A delegate based flow layout control
+//
+//  Copyright 2016 (c) Kevin Xi(kevinxi.cn@gmail.com)
+//	All rights reserved.
+//
+
+#pragma once
+
+#include "UIlib.h"
+#include <list>
+#include <map>
+
+namespace DuiLib
+{
+
+// Default memory budget of the tile cache (32MB).
+static const SIZE_T UICollectionViewTileCacheDefaultBudget = 32 * 1024 * 1024;
+
+// Default edge length of a tile in pixels.
+static const int UICollectionViewTileCacheDefaultTileSize = 256;
+
+// Counters of the tile cache.
+struct UICollectionViewTileCacheStats
+{
+	UINT64 nRasterized; // tiles painted from items and cached.
+	UINT64 nReused; // tiles composited from the cache.
+	UINT64 nEvictions; // tiles dropped to stay under budget.
+	int nFrameRasterized; // tiles rasterized by the last frame.
+	int nFrameReused; // tiles reused by the last frame.
+	SIZE_T nBytes; // memory consumed by cached tiles.
+	SIZE_T nBudget; // memory budget.
+	int nCount; // number of cached tiles.
+};
+
+// A backing store of the content view, made up of fixed-size opaque tiles keyed by their (column, row)
+// in content coordinates, so a tile stays valid while the content scrolls. Painting a cached tile is a
+// single blit instead of painting every item inside it. Tiles must be invalidated when an item inside
+// them changes, and least recently used tiles are evicted to stay under the memory budget.
+class UICollectionViewTileCache
+{
+public:
+
+	// Constructor.
+	UICollectionViewTileCache(int nTileSize = UICollectionViewTileCacheDefaultTileSize, SIZE_T nBudget = UICollectionViewTileCacheDefaultBudget);
+
+	// Destructor.
+	~UICollectionViewTileCache();
+
+	// Get the edge length of a tile.
+	int GetTileSize() const { return m_nTileSize; }
+
+	// Set the edge length of a tile, all tiles are removed.
+	void SetTileSize(int nTileSize);
+
+	// Blit the part of a cached tile within `rcPaint`, the tile is at `rcTile` on the DC.
+	// Return false if the tile is not cached.
+	bool Draw(int nColumn, int nRow, HDC hDC, const RECT &rcTile, const RECT &rcPaint);
+
+	// Cache a tile by copying the pixels at `rcTile` from the DC, which must be fully painted.
+	bool Rasterize(int nColumn, int nRow, HDC hDC, const RECT &rcTile);
+
+	// Remove tiles intersecting a rect in content coordinates.
+	void Invalidate(const RECT &rcContent);
+
+	// Remove all tiles.
+	void RemoveAll();
+
+	// Get the memory budget in bytes.
+	SIZE_T GetBudget() const { return m_nBudget; }
+
+	// Set the memory budget in bytes.
+	void SetBudget(SIZE_T nBudget);
+
+	// Start counting tiles of a new frame.
+	void BeginFrame();
+
+	// Get rasterized / reused / eviction counters.
+	UICollectionViewTileCacheStats GetStats() const;
+
+	// Reset rasterized / reused / eviction counters.
+	void ResetStats();
+
+protected:
+
+	// Evict least recently used tiles until we are under budget.
+	void Trim();
+
+	// Get the memory consumed by a tile.
+	SIZE_T GetTileByteSize() const { return (SIZE_T)m_nTileSize * m_nTileSize * sizeof(DWORD); }
+
+private:
+
+	typedef std::pair<int, int> Key; // row, column.
+	typedef std::pair<Key, HBITMAP> Entry;
+
+	int m_nTileSize; // edge length of a tile.
+	HDC m_hMemDC; // to select tiles into.
+	SIZE_T m_nBudget; // memory budget.
+	UINT64 m_nRasterized; // rasterized tiles.
+	UINT64 m_nReused; // reused tiles.
+	UINT64 m_nEvictions; // evicted tiles.
+	int m_nFrameRasterized; // rasterized tiles in current frame.
+	int m_nFrameReused; // reused tiles in current frame.
+	int m_nLastFrameRasterized; // rasterized tiles in last frame.
+	int m_nLastFrameReused; // reused tiles in last frame.
+	std::list<Entry> m_Entries; // most recently used first.
+	std::map<Key, std::list<Entry>::iterator> m_Index; // locate entries by key.
+};
+
+}